@@ -0,0 +1,517 @@
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include "../limereport/lrreportengine.h"
+#include "../limereport/lrdatasourcemanagerintf.h"
+#include "../limereport/lrcolumnardatatable.h"
+
+namespace {
+
+const int FLAT_LIST_ROWS = 100000;
+const int GROUPED_ROWS = 50000;
+const int MASTER_ROWS = 2000;
+const int DETAIL_ROWS_PER_MASTER = 10;
+const int WIDE_GRID_ROWS = 5000;
+const int WIDE_GRID_COLUMNS = 100;
+const int LABEL_ROWS = 5000;
+const int XML_ROUND_TRIPS = 10;
+
+// Peak resident set size of the process in KB, -1 where it is not available.
+// The value never decreases, so run a single benchmark per process
+// (e.g. "tst_renderbenchmarks renderFlatList") to get its own peak.
+qint64 peakMemoryKb()
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+    foreach(QByteArray line, status.readAll().split('\n')){
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return -1;
+}
+
+QString xmlEscape(QString value)
+{
+    return value.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;");
+}
+
+QString stringProperty(const QString& name, const QString& value)
+{
+    return QString("<%1 Type=\"QString\">%2</%1>").arg(name).arg(xmlEscape(value));
+}
+
+QString intProperty(const QString& name, int value)
+{
+    return QString("<%1 Type=\"int\" Value=\"%2\"/>").arg(name).arg(value);
+}
+
+QString boolProperty(const QString& name, bool value)
+{
+    return QString("<%1 Type=\"bool\" Value=\"%2\"/>").arg(name).arg(value ? 1 : 0);
+}
+
+QString geometry(int x, int y, int width, int height)
+{
+    return QString("<geometry x=\"%1\" y=\"%2\" width=\"%3\" height=\"%4\" Type=\"QRect\"/>")
+            .arg(x).arg(y).arg(width).arg(height);
+}
+
+QString item(const QString& className, const QString& name, const QString& parentName,
+             const QString& rect, const QString& properties)
+{
+    return QString("<item ClassName=\"%1\" Type=\"Object\">%2%3<children Type=\"Collection\"/>%4%5</item>")
+            .arg(className)
+            .arg(stringProperty("objectName", name))
+            .arg(rect)
+            .arg(stringProperty("parentName", parentName))
+            .arg(properties);
+}
+
+QString textItem(const QString& name, const QString& band, int x, int width, const QString& content)
+{
+    return item("TextItem", name, band, geometry(x, 0, width, 40), stringProperty("content", content));
+}
+
+QString band(const QString& className, const QString& name, int bandIndex, int height,
+             const QString& children, const QString& properties = QString())
+{
+    return QString("<item ClassName=\"%1\" Type=\"Object\">%2%3<children Type=\"Collection\">%4</children>%5%6%7</item>")
+            .arg(className)
+            .arg(stringProperty("objectName", name))
+            .arg(geometry(50, 50 + bandIndex * 100, 2000, height))
+            .arg(children)
+            .arg(stringProperty("parentName", "ReportPage1"))
+            .arg(intProperty("bandIndex", bandIndex))
+            .arg(properties);
+}
+
+QString pageFooter(int bandIndex, bool withPageCount)
+{
+    QString content = withPageCount ? "$V{#PAGE} / $V{#PAGE_COUNT}" : "$V{#PAGE}";
+    return band("PageFooter", "PageFooter1", bandIndex, 50,
+                textItem("PageNumber", "PageFooter1", 1500, 500, content));
+}
+
+QString reportTemplate(const QString& bands, const QString& datasources = QString())
+{
+    return QString(
+        "<Report><object ClassName=\"LimeReport::ReportEnginePrivate\" Type=\"Object\">"
+        "<objectName Type=\"QString\"></objectName>"
+        "<pages Type=\"Collection\">"
+        "<item ClassName=\"LimeReport::PageDesignIntf\" Type=\"Object\">"
+        "<objectName Type=\"QString\">page1</objectName>"
+        "<pageItem ClassName=\"PageItem\" Type=\"Object\">"
+        "<objectName Type=\"QString\">ReportPage1</objectName>"
+        "<geometry x=\"0\" y=\"0\" width=\"2100\" height=\"2970\" Type=\"QRect\"/>"
+        "<children Type=\"Collection\">%1</children>"
+        "</pageItem></item></pages>"
+        "<datasourcesManager ClassName=\"LimeReport::DataSourceManager\" Type=\"Object\">"
+        "<objectName Type=\"QString\">datasources</objectName>%2"
+        "</datasourcesManager></object></Report>"
+    ).arg(bands).arg(datasources);
+}
+
+QString flatListTemplate(bool withPageCount)
+{
+    QString children =
+            textItem("Id", "DataBand1", 0, 200, "$D{list.Id}") +
+            textItem("Name", "DataBand1", 200, 800, "$D{list.Name}") +
+            textItem("Amount", "DataBand1", 1000, 400, "$D{list.Amount}") +
+            textItem("Created", "DataBand1", 1400, 400, "$D{list.Created}");
+    return reportTemplate(
+        band("Data", "DataBand1", 0, 40, children, stringProperty("datasource", "list")) +
+        pageFooter(1, withPageCount)
+    );
+}
+
+QString groupedTemplate()
+{
+    QStringList levels;
+    levels << "Region" << "Country" << "City";
+    QString bands;
+    for (int i = 0; i < levels.count(); ++i){
+        QString header = QString("GroupHeader%1").arg(i + 1);
+        QString footer = QString("GroupFooter%1").arg(i + 1);
+        bands += band("GroupHeader", header, i, 40,
+                      textItem(header + "Text", header, 0, 800, QString("$D{sales.%1}").arg(levels.at(i))),
+                      stringProperty("parentBand", "DataBand1") +
+                      stringProperty("groupFieldName", levels.at(i)));
+        QString aggregates =
+                textItem(footer + "Sum", footer, 0, 500, "$S{SUM($D{sales.Amount},\"DataBand1\")}") +
+                textItem(footer + "Avg", footer, 500, 500, "$S{AVG($D{sales.Amount},\"DataBand1\")}") +
+                textItem(footer + "Count", footer, 1000, 500, "$S{COUNT(\"DataBand1\")}");
+        bands += band("GroupFooter", footer, 2 * levels.count() - i, 40, aggregates,
+                      stringProperty("parentBand", header));
+    }
+    QString children =
+            textItem("City", "DataBand1", 0, 800, "$D{sales.City}") +
+            textItem("Amount", "DataBand1", 800, 400, "$D{sales.Amount}");
+    bands += band("Data", "DataBand1", levels.count(), 40, children, stringProperty("datasource", "sales"));
+    return reportTemplate(bands + pageFooter(2 * levels.count() + 1, false));
+}
+
+QString masterDetailTemplate(const QString& databaseName)
+{
+    QString masterChildren =
+            textItem("OrderId", "DataBand1", 0, 300, "$D{orders.id}") +
+            textItem("Customer", "DataBand1", 300, 1000, "$D{orders.customer}");
+    QString detailChildren =
+            textItem("Product", "SubDetailBand1", 100, 800, "$D{items.product}") +
+            textItem("Quantity", "SubDetailBand1", 900, 300, "$D{items.qty}") +
+            textItem("Price", "SubDetailBand1", 1200, 300, "$D{items.price}");
+    QString footerChildren =
+            textItem("Total", "SubDetailFooterBand1", 900, 600, "$S{SUM($D{items.qty},\"SubDetailBand1\")}");
+    QString bands =
+            band("Data", "DataBand1", 0, 40, masterChildren, stringProperty("datasource", "orders")) +
+            band("SubDetail", "SubDetailBand1", 1, 40, detailChildren,
+                 stringProperty("parentBand", "DataBand1") + stringProperty("datasource", "items")) +
+            band("SubDetailFooter", "SubDetailFooterBand1", 2, 40, footerChildren,
+                 stringProperty("parentBand", "SubDetailBand1"));
+    QString datasources = QString(
+        "<connections Type=\"Collection\">"
+        "<item ClassName=\"LimeReport::ConnectionDesc\" Type=\"Object\">%1%2%3%4</item>"
+        "</connections>"
+        "<queries Type=\"Collection\">"
+        "<item ClassName=\"LimeReport::QueryDesc\" Type=\"Object\">%5%6%7</item>"
+        "</queries>"
+        "<subqueries Type=\"Collection\">"
+        "<item ClassName=\"LimeReport::SubQueryDesc\" Type=\"Object\">%8%9%7%10</item>"
+        "</subqueries>")
+            .arg(stringProperty("name", "benchmark"))
+            .arg(stringProperty("driver", "QSQLITE"))
+            .arg(stringProperty("databaseName", databaseName))
+            .arg(boolProperty("autoconnect", true))
+            .arg(stringProperty("queryName", "orders"))
+            .arg(stringProperty("queryText", "select id, customer from orders order by id"))
+            .arg(stringProperty("connectionName", "benchmark"))
+            .arg(stringProperty("queryName", "items"))
+            .arg(stringProperty("queryText", "select product, qty, price from items where order_id = $D{orders.id}"))
+            .arg(stringProperty("master", "orders"));
+    return reportTemplate(bands, datasources);
+}
+
+QString wideGridTemplate()
+{
+    int columnWidth = 2000 / WIDE_GRID_COLUMNS;
+    QString children;
+    for (int i = 0; i < WIDE_GRID_COLUMNS; ++i)
+        children += textItem(QString("Cell%1").arg(i), "DataBand1", i * columnWidth, columnWidth,
+                             QString("$D{grid.Col%1}").arg(i));
+    return reportTemplate(band("Data", "DataBand1", 0, 40, children, stringProperty("datasource", "grid")));
+}
+
+QString labelsTemplate()
+{
+    QString children =
+            item("ImageItem", "Picture", "DataBand1", geometry(0, 0, 400, 300),
+                 stringProperty("datasource", "labels") + stringProperty("field", "Picture")) +
+            item("BarcodeItem", "Barcode", "DataBand1", geometry(450, 0, 800, 300),
+                 stringProperty("datasource", "labels") + stringProperty("field", "Code")) +
+            textItem("Caption", "DataBand1", 1300, 700, "$D{labels.Caption}");
+    return reportTemplate(band("Data", "DataBand1", 0, 300, children, stringProperty("datasource", "labels")));
+}
+
+LimeReport::ColumnarDataTable flatListData(int rows)
+{
+    QVector<qint64> ids(rows);
+    QVector<QString> names(rows);
+    QVector<double> amounts(rows);
+    QVector<QDate> created(rows);
+    QDate start(2020, 1, 1);
+    for (int i = 0; i < rows; ++i){
+        ids[i] = i + 1;
+        names[i] = QString("Customer %1").arg(i % 997);
+        amounts[i] = (i * 37 % 10000) / 100.0;
+        created[i] = start.addDays(i % 1000);
+    }
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("Id", ids);
+    table.addColumn("Name", names);
+    table.addColumn("Amount", amounts);
+    table.addColumn("Created", created);
+    return table;
+}
+
+LimeReport::ColumnarDataTable groupedData(int rows)
+{
+    // rows are generated already ordered by Region, Country, City
+    QVector<QString> regions(rows);
+    QVector<QString> countries(rows);
+    QVector<QString> cities(rows);
+    QVector<double> amounts(rows);
+    for (int i = 0; i < rows; ++i){
+        int city = i / 20;
+        regions[i] = QString("Region %1").arg(city / 250, 3, 10, QChar('0'));
+        countries[i] = QString("Country %1").arg(city / 25, 4, 10, QChar('0'));
+        cities[i] = QString("City %1").arg(city, 5, 10, QChar('0'));
+        amounts[i] = (i * 53 % 10000) / 100.0;
+    }
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("Region", regions);
+    table.addColumn("Country", countries);
+    table.addColumn("City", cities);
+    table.addColumn("Amount", amounts);
+    return table;
+}
+
+LimeReport::ColumnarDataTable wideGridData(int rows, int columns)
+{
+    LimeReport::ColumnarDataTable table;
+    for (int column = 0; column < columns; ++column){
+        QVector<double> values(rows);
+        for (int row = 0; row < rows; ++row)
+            values[row] = (row * columns + column) % 100000 / 10.0;
+        table.addColumn(QString("Col%1").arg(column), values);
+    }
+    return table;
+}
+
+QByteArray labelPicture(int index)
+{
+    QImage image(200, 150, QImage::Format_ARGB32);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, 200, 150);
+    gradient.setColorAt(0, QColor::fromHsv(index * 36 % 360, 200, 230));
+    gradient.setColorAt(1, Qt::white);
+    painter.fillRect(image.rect(), gradient);
+    painter.drawText(image.rect(), Qt::AlignCenter, QString::number(index));
+    painter.end();
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data;
+}
+
+LimeReport::ColumnarDataTable labelsData(int rows)
+{
+    QVector<QByteArray> pictures;
+    for (int i = 0; i < 10; ++i)
+        pictures.append(labelPicture(i));
+    QVector<QString> codes(rows);
+    QVector<QString> captions(rows);
+    QVector<QByteArray> images(rows);
+    for (int i = 0; i < rows; ++i){
+        codes[i] = QString("LR%1").arg(i, 10, 10, QChar('0'));
+        captions[i] = QString("Item %1").arg(i);
+        images[i] = pictures.at(i % pictures.count());
+    }
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("Code", codes);
+    table.addColumn("Caption", captions);
+    table.addColumn("Picture", images);
+    return table;
+}
+
+bool createMasterDetailDatabase(const QString& fileName)
+{
+    QFile::remove(fileName);
+    bool result = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "benchmark_setup");
+        db.setDatabaseName(fileName);
+        if (!db.open()) return false;
+        QSqlQuery query(db);
+        result = query.exec("create table orders(id integer primary key, customer text)") &&
+                 query.exec("create table items(order_id integer, product text, qty integer, price real)") &&
+                 query.exec("create index items_order on items(order_id)");
+        db.transaction();
+        QSqlQuery insertOrder(db);
+        insertOrder.prepare("insert into orders values(?, ?)");
+        QSqlQuery insertItem(db);
+        insertItem.prepare("insert into items values(?, ?, ?, ?)");
+        for (int order = 1; result && order <= MASTER_ROWS; ++order){
+            insertOrder.addBindValue(order);
+            insertOrder.addBindValue(QString("Customer %1").arg(order % 313));
+            result = insertOrder.exec();
+            for (int i = 0; result && i < DETAIL_ROWS_PER_MASTER; ++i){
+                insertItem.addBindValue(order);
+                insertItem.addBindValue(QString("Product %1").arg((order + i) % 77));
+                insertItem.addBindValue(i + 1);
+                insertItem.addBindValue((order * 7 + i) % 1000 / 10.0);
+                result = insertItem.exec();
+            }
+        }
+        db.commit();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("benchmark_setup");
+    return result;
+}
+
+} // namespace
+
+class RenderBenchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    RenderBenchmarks();
+private:
+    void loadTemplate(LimeReport::ReportEngine& report, const QString& xml);
+    void renderFlatList(bool withPageCount);
+    QString tempFileName(const QString& name);
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void renderFlatList();
+    void renderFlatListWithSecondPass();
+    void renderGroupsWithAggregates();
+    void renderMasterDetailSqlite();
+    void renderWideGrid();
+    void renderImageBarcodeLabels();
+    void exportFlatListToPdf();
+    void saveWideGridToXml();
+    void loadWideGridFromXml();
+private:
+    QString m_databaseName;
+};
+
+RenderBenchmarks::RenderBenchmarks()
+{
+}
+
+void RenderBenchmarks::loadTemplate(LimeReport::ReportEngine &report, const QString &xml)
+{
+    report.setShowProgressDialog(false);
+    QVERIFY2(report.loadFromString(xml), qPrintable(report.lastError()));
+}
+
+QString RenderBenchmarks::tempFileName(const QString &name)
+{
+    return QDir::temp().absoluteFilePath(QString("lr_benchmark_%1_%2").arg(QCoreApplication::applicationPid()).arg(name));
+}
+
+void RenderBenchmarks::initTestCase()
+{
+    m_databaseName = tempFileName("master_detail.db");
+    QVERIFY(createMasterDetailDatabase(m_databaseName));
+}
+
+void RenderBenchmarks::cleanupTestCase()
+{
+    QFile::remove(m_databaseName);
+}
+
+void RenderBenchmarks::cleanup()
+{
+    qDebug() << "peak memory, KB:" << peakMemoryKb();
+}
+
+void RenderBenchmarks::renderFlatList(bool withPageCount)
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, flatListTemplate(withPageCount));
+    report.dataManager()->addColumnarData("list", flatListData(FLAT_LIST_ROWS));
+    QBENCHMARK_ONCE {
+        QVERIFY(report.prepareReportPages());
+    }
+}
+
+void RenderBenchmarks::renderFlatList()
+{
+    renderFlatList(false);
+}
+
+// Same report as renderFlatList() with "#PAGE_COUNT" in the page footer;
+// the difference between both results is the cost of the second pass.
+void RenderBenchmarks::renderFlatListWithSecondPass()
+{
+    renderFlatList(true);
+}
+
+void RenderBenchmarks::renderGroupsWithAggregates()
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, groupedTemplate());
+    report.dataManager()->addColumnarData("sales", groupedData(GROUPED_ROWS));
+    QBENCHMARK_ONCE {
+        QVERIFY(report.prepareReportPages());
+    }
+}
+
+void RenderBenchmarks::renderMasterDetailSqlite()
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, masterDetailTemplate(m_databaseName));
+    QBENCHMARK_ONCE {
+        QVERIFY2(report.prepareReportPages(), qPrintable(report.lastError()));
+    }
+}
+
+void RenderBenchmarks::renderWideGrid()
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, wideGridTemplate());
+    report.dataManager()->addColumnarData("grid", wideGridData(WIDE_GRID_ROWS, WIDE_GRID_COLUMNS));
+    QBENCHMARK_ONCE {
+        QVERIFY(report.prepareReportPages());
+    }
+}
+
+void RenderBenchmarks::renderImageBarcodeLabels()
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, labelsTemplate());
+    report.dataManager()->addColumnarData("labels", labelsData(LABEL_ROWS));
+    QBENCHMARK_ONCE {
+        QVERIFY(report.prepareReportPages());
+    }
+}
+
+// printToPDF() renders the report before exporting it; subtract the
+// renderFlatList() result to get the export alone.
+void RenderBenchmarks::exportFlatListToPdf()
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, flatListTemplate(false));
+    report.dataManager()->addColumnarData("list", flatListData(FLAT_LIST_ROWS));
+    QString fileName = tempFileName("flat_list.pdf");
+    QBENCHMARK_ONCE {
+        QVERIFY(report.printToPDF(fileName));
+    }
+    qDebug() << "pdf size, KB:" << QFileInfo(fileName).size() / 1024;
+    QFile::remove(fileName);
+}
+
+void RenderBenchmarks::saveWideGridToXml()
+{
+    LimeReport::ReportEngine report;
+    loadTemplate(report, wideGridTemplate());
+    QString xml;
+    QBENCHMARK {
+        for (int i = 0; i < XML_ROUND_TRIPS; ++i)
+            xml = report.saveToString();
+    }
+    QVERIFY(!xml.isEmpty());
+}
+
+void RenderBenchmarks::loadWideGridFromXml()
+{
+    QString xml;
+    {
+        LimeReport::ReportEngine report;
+        loadTemplate(report, wideGridTemplate());
+        xml = report.saveToString();
+    }
+    LimeReport::ReportEngine report;
+    report.setShowProgressDialog(false);
+    QBENCHMARK {
+        for (int i = 0; i < XML_ROUND_TRIPS; ++i)
+            QVERIFY(report.loadFromString(xml));
+    }
+}
+
+QTEST_MAIN(RenderBenchmarks)
+
+#include "tst_renderbenchmarks.moc"
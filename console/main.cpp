@@ -6,14 +6,244 @@
 #include <QDir>
 #include <QFile>
 #include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
 
 #ifdef _WIN32
   #include <io.h>
   #include <fcntl.h>
 #endif
 
+#if QT_VERSION > QT_VERSION_CHECK(5, 2, 0)
+
+struct BatchJob{
+    QString source;
+    QString destination;
+    QStringList params;
+};
+
+static void setReportVariables(LimeReport::ReportEngine& report, const QStringList& params)
+{
+    foreach(QString var, params){
+        QStringList varItem = var.split("=");
+        if (varItem.size() == 2)
+            report.dataManager()->setReportVariable(varItem.at(0),varItem.at(1));
+    }
+}
+
+static QString outputFileName(const QString& source, const QString& destination)
+{
+    return destination.isEmpty() ? QFileInfo(source).baseName() : destination;
+}
+
+// Manifest is either a JSON array of {"source", "destination", "params": {name: value}}
+// objects or a text file with one "source,destination[,name=value...]" job per line.
+static bool readBatchManifest(QIODevice& device, QList<BatchJob>& jobs, QString& error)
+{
+    QByteArray data = device.readAll();
+    if (data.trimmed().startsWith('[')){
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+        if (document.isNull()){
+            error = parseError.errorString();
+            return false;
+        }
+        foreach(QJsonValue value, document.array()){
+            QJsonObject object = value.toObject();
+            BatchJob job;
+            job.source = object.value("source").toString();
+            job.destination = object.value("destination").toString();
+            QJsonObject params = object.value("params").toObject();
+            foreach(QString name, params.keys())
+                job.params.append(name + "=" + params.value(name).toVariant().toString());
+            jobs.append(job);
+        }
+    } else {
+        foreach(QString line, QString::fromUtf8(data).split('\n')){
+            line = line.trimmed();
+            if (line.isEmpty() || line.startsWith('#')) continue;
+            QStringList fields = line.split(',');
+            BatchJob job;
+            job.source = fields.takeFirst().trimmed();
+            if (!fields.isEmpty())
+                job.destination = fields.takeFirst().trimmed();
+            foreach(QString param, fields)
+                job.params.append(param.trimmed());
+            jobs.append(job);
+        }
+    }
+    foreach(BatchJob job, jobs){
+        if (job.source.isEmpty()){
+            error = "job without source";
+            return false;
+        }
+    }
+    return true;
+}
+
+static QByteArray batchManifest(const QList<BatchJob>& jobs)
+{
+    QJsonArray array;
+    foreach(BatchJob job, jobs){
+        QJsonObject object;
+        object.insert("source", job.source);
+        object.insert("destination", job.destination);
+        QJsonObject params;
+        foreach(QString var, job.params){
+            QStringList varItem = var.split("=");
+            if (varItem.size() == 2)
+                params.insert(varItem.at(0), varItem.at(1));
+        }
+        object.insert("params", params);
+        array.append(object);
+    }
+    return QJsonDocument(array).toJson(QJsonDocument::Compact);
+}
+
+// Templates stay loaded, and their database connections open, for the whole
+// batch; one engine per template file. Variables set by a job are restored
+// before the next job using the same template.
+static int runBatchJobs(const QList<BatchJob>& jobs)
+{
+    QHash<QString, LimeReport::ReportEngine*> engines;
+    int failed = 0;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    foreach(BatchJob job, jobs){
+        QElapsedTimer timer;
+        timer.start();
+        QString destination = outputFileName(job.source, job.destination);
+        QString source = QFileInfo(job.source).absoluteFilePath();
+        LimeReport::ReportEngine* report = engines.value(source);
+        if (!report){
+            report = new LimeReport::ReportEngine();
+            report->setShowProgressDialog(false);
+            if (!report->loadFromFile(source)){
+                delete report;
+                std::cout<<"FAILED\t"<<timer.elapsed()<<"\t"<<destination.toStdString()
+                         <<"\tReport file \""<<job.source.toStdString()<<"\" not found"<<std::endl;
+                ++failed;
+                continue;
+            }
+            engines.insert(source, report);
+        }
+
+        QMap<QString, QVariant> previousValues;
+        QStringList addedVariables;
+        foreach(QString var, job.params){
+            QStringList varItem = var.split("=");
+            if (varItem.size() != 2) continue;
+            QString name = varItem.at(0);
+            if (report->dataManager()->containsVariable(name))
+                previousValues.insert(name, report->dataManager()->variable(name));
+            else
+                addedVariables.append(name);
+        }
+        setReportVariables(*report, job.params);
+
+        bool result = report->printToPDF(destination);
+        if (result){
+            std::cout<<"OK\t"<<timer.elapsed()<<"\t"<<destination.toStdString()<<std::endl;
+        } else {
+            std::cout<<"FAILED\t"<<timer.elapsed()<<"\t"<<destination.toStdString()
+                     <<"\t"<<report->lastError().toStdString()<<std::endl;
+            ++failed;
+        }
+
+        foreach(QString name, addedVariables)
+            report->dataManager()->deleteVariable(name);
+        foreach(QString name, previousValues.keys())
+            report->dataManager()->setReportVariable(name, previousValues.value(name));
+    }
+    qDeleteAll(engines);
+    std::cerr<<jobs.count()<<" jobs, "<<failed<<" failed, "<<batchTimer.elapsed()<<" ms\n";
+    return failed;
+}
+
+// Workers are child processes running "--batch -" on their share of the jobs;
+// jobs with the same template go to the same worker to keep it warm.
+static int runBatchWorkers(QList<BatchJob> jobs, int workerCount)
+{
+    QMap<QString, QList<BatchJob> > jobsBySource;
+    foreach(BatchJob job, jobs)
+        jobsBySource[QFileInfo(job.source).absoluteFilePath()].append(job);
+    jobs.clear();
+    foreach(QString source, jobsBySource.keys())
+        jobs.append(jobsBySource.value(source));
+
+    QList<QProcess*> workers;
+    int first = 0;
+    for (int i = 0; i < workerCount && first < jobs.count(); ++i){
+        int last = int(qint64(jobs.count()) * (i + 1) / workerCount);
+        QProcess* worker = new QProcess();
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        worker->start(QCoreApplication::applicationFilePath(), QStringList() << "--batch" << "-");
+        // without an event loop stdin is only flushed while waiting, so the
+        // manifest is pushed out here instead of in waitForFinished() below,
+        // which would leave the workers to run one after another
+        if (worker->waitForStarted(-1)){
+            worker->write(batchManifest(jobs.mid(first, last - first)));
+            while (worker->bytesToWrite() > 0 && worker->waitForBytesWritten(-1)){}
+        }
+        worker->closeWriteChannel();
+        workers.append(worker);
+        first = last;
+    }
+
+    int failed = 0;
+    foreach(QProcess* worker, workers){
+        worker->waitForFinished(-1);
+        if (worker->error() == QProcess::FailedToStart ||
+            worker->exitStatus() != QProcess::NormalExit || worker->exitCode() != 0)
+            ++failed;
+    }
+    qDeleteAll(workers);
+    return failed;
+}
+
+// Peak resident set size in KB where /proc is available, -1 otherwise.
+static qint64 peakMemoryKb()
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+    foreach(QByteArray line, status.readAll().split('\n')){
+        if (line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return -1;
+}
+
+static void printStats(qint64 startupTime)
+{
+    std::cerr<<"startup "<<startupTime<<" ms, peak memory "<<peakMemoryKb()<<" KB\n";
+}
+
+// The platform has to be chosen before QApplication exists, that is before
+// QCommandLineParser can be used.
+static bool hasArgument(int argc, char *argv[], const char* argument)
+{
+    for (int i = 1; i < argc; ++i){
+        if (qstrcmp(argv[i], argument) == 0) return true;
+    }
+    return false;
+}
+
+#endif
+
 int main(int argc, char *argv[])
 {
+#if QT_VERSION > QT_VERSION_CHECK(5, 2, 0)
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    // --headless renders without a display server; it needs the offscreen
+    // platform plugin, and an explicit QT_QPA_PLATFORM still wins
+    if (hasArgument(argc, argv, "--headless") && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
     QApplication a(argc, argv);
     QApplication::setApplicationVersion(LIMEREPORT_VERSION_STR);
     QStringList vars;
@@ -34,9 +264,50 @@ int main(int argc, char *argv[])
                QCoreApplication::translate("main", "Report parameter (can be more than one)"),
                QCoreApplication::translate("main", "param_name=param_value"));
     parser.addOption(variablesOption);
+    QCommandLineOption batchOption(QStringList() << "b" << "batch",
+               QCoreApplication::translate("main", "Job list: JSON array or \"source,destination[,param_name=param_value...]\" lines, \"-\" for stdin"),
+               QCoreApplication::translate("main", "manifest"));
+    parser.addOption(batchOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+               QCoreApplication::translate("main", "Number of parallel batch workers"),
+               QCoreApplication::translate("main", "count"), "1");
+    parser.addOption(jobsOption);
+    QCommandLineOption statsOption(QStringList() << "stats",
+               QCoreApplication::translate("main", "Print startup time and peak memory usage"));
+    parser.addOption(statsOption);
+    QCommandLineOption headlessOption(QStringList() << "headless",
+               QCoreApplication::translate("main", "Run on the offscreen platform, without a display server"));
+    parser.addOption(headlessOption);
     parser.process(a);
+    qint64 startupTime = startupTimer.elapsed();
+
+    if (!parser.value(batchOption).isEmpty()){
+        QFile manifest;
+        if (parser.value(batchOption) == "-")
+            manifest.open(stdin, QIODevice::ReadOnly);
+        else {
+            manifest.setFileName(parser.value(batchOption));
+            manifest.open(QIODevice::ReadOnly);
+        }
+        if (!manifest.isOpen()){
+            std::cerr<<"Error! Batch file \""+parser.value(batchOption).toStdString()+"\" not found \n";
+            return 1;
+        }
+        QList<BatchJob> jobs;
+        QString error;
+        if (!readBatchManifest(manifest, jobs, error)){
+            std::cerr<<"Error! Batch file is invalid: "+error.toStdString()+"\n";
+            return 1;
+        }
+        int workerCount = qMax(parser.value(jobsOption).toInt(), 1);
+        int failed = workerCount > 1 && jobs.count() > 1 ? runBatchWorkers(jobs, workerCount)
+                                                         : runBatchJobs(jobs);
+        if (parser.isSet(statsOption)) printStats(startupTime);
+        return failed > 0 ? 1 : 0;
+    }
 
     LimeReport::ReportEngine report;
+    report.setShowProgressDialog(false);
 
     if (parser.value(sourceOption).isEmpty()){
         std::cerr<<"Error! Report file is not specified !! \n";
@@ -48,19 +319,10 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    if (!parser.values(variablesOption).isEmpty()){
-        foreach(QString var, parser.values(variablesOption)){
-            QStringList varItem = var.split("=");
-            if (varItem.size() == 2)
-                report.dataManager()->setReportVariable(varItem.at(0),varItem.at(1));
-        }
-    }
+    setReportVariables(report, parser.values(variablesOption));
 
-    if (parser.value(destinationOption).isEmpty()){
-        report.printToPDF(QFileInfo(parser.value(sourceOption)).baseName());
-    } else {
-        report.printToPDF(parser.value(destinationOption));
-    }
+    report.printToPDF(outputFileName(parser.value(sourceOption), parser.value(destinationOption)));
+    if (parser.isSet(statsOption)) printStats(startupTime);
 #else
     std::cerr<<"This demo intended for Qt 5.2 and higher\n";
 #endif
@@ -88,8 +88,8 @@ void GroupBandHeader::startGroup(DataSourceManager* dataManager)
 {
     m_groupStarted=true;
 
-    QString lineVar = QLatin1String("line_")+objectName().toLower();
-    dataManager->setReportVariable(lineVar,1);
+    int lineSlot = dataManager->renderVariableSlot(QLatin1String("line_")+objectName().toLower());
+    dataManager->setRenderVariable(lineSlot,1);
 
     QString datasourceName = findDataSourceName(parentBand());
     if (dataManager->containsDatasource(datasourceName)){
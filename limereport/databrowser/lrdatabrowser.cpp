@@ -615,8 +615,17 @@ void DataBrowser::addSubQuery(SQLEditResult result)
 void DataBrowser::changeSubQuery(SQLEditResult result)
 {
     try {
+        QString batchKeyField;
+        int batchSize = 0;
+        SubQueryDesc* oldDesc = m_report->dataManager()->subQueryByName(result.oldDatasourceName);
+        if (oldDesc){
+            batchKeyField = oldDesc->batchKeyField();
+            batchSize = oldDesc->batchSize();
+        }
         m_report->dataManager()->removeDatasource(result.oldDatasourceName);
         addSubQuery(result);
+        if (batchSize != 0)
+            m_report->dataManager()->setSubQueryBatchMode(result.datasourceName, batchKeyField, batchSize);
     } catch(ReportError &exception){
         qDebug()<<exception.what();
     }
@@ -658,8 +667,31 @@ void DataBrowser::addCSV(SQLEditResult result)
 void DataBrowser::changeCSV(SQLEditResult result)
 {
     try {
+        bool inferTypes = false;
+        QString fileName;
+        CSVDesc* oldDesc = m_report->dataManager()->csvByName(result.oldDatasourceName);
+        if (oldDesc){
+            inferTypes = oldDesc->inferTypes();
+            fileName = oldDesc->fileName();
+        }
         m_report->dataManager()->removeDatasource(result.oldDatasourceName);
-        addCSV(result);
+        if (!fileName.isEmpty() && result.csv.isEmpty()){
+            m_report->dataManager()->addCSVFile(
+                result.datasourceName,
+                fileName,
+                result.separator,
+                result.firstRowIsHeader,
+                inferTypes
+            );
+        } else {
+            m_report->dataManager()->addCSV(
+                result.datasourceName,
+                result.csv,
+                result.separator,
+                result.firstRowIsHeader,
+                inferTypes
+            );
+        }
     } catch(ReportError &exception){
         qDebug()<<exception.what();
     }
@@ -0,0 +1,346 @@
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "lrimageexporter.h"
+#include "lrexportersfactory.h"
+#include "lrreportengine_p.h"
+#include "lrpagedesignintf.h"
+
+namespace{
+
+LimeReport::ReportExporterInterface* createImageExporter(LimeReport::ReportEnginePrivate* parent){
+    return new LimeReport::ImageExporter(parent);
+}
+
+bool VARIABLE_IS_NOT_USED registred = LimeReport::ExportersFactory::instance().registerCreator("IMAGE", LimeReport::ExporterAttribs(QObject::tr("Export to image"), "ImageExporter"), createImageExporter);
+
+struct EncodedPage{
+    QByteArray strip;
+    QSize size;
+};
+
+// Shared by the painting thread and the encoders of one export. inFlight
+// bounds the number of painted pages that are not written yet.
+class ExportState{
+public:
+    explicit ExportState(int buffers): inFlight(buffers), m_failed(false){}
+    void setError(const QString& message)
+    {
+        QMutexLocker locker(&mutex);
+        if (!m_failed){
+            m_failed = true;
+            m_error = message;
+        }
+        encoded.wakeAll();
+    }
+    bool isFailed()
+    {
+        QMutexLocker locker(&mutex);
+        return m_failed;
+    }
+    QString error()
+    {
+        QMutexLocker locker(&mutex);
+        return m_error;
+    }
+    QSemaphore inFlight;
+    QMutex mutex;
+    QWaitCondition encoded;
+    QMap<int, EncodedPage> encodedPages;
+private:
+    bool m_failed;
+    QString m_error;
+};
+
+class WriteImageTask : public QRunnable{
+public:
+    WriteImageTask(ExportState* state, const QImage& image, const QString& fileName, const QByteArray& format, int quality)
+        : m_state(state), m_image(image), m_fileName(fileName), m_format(format), m_quality(quality){}
+    void run()
+    {
+        QImageWriter writer(m_fileName, m_format);
+        writer.setQuality(m_quality);
+        if (!writer.write(m_image))
+            m_state->setError(QString("%1: %2").arg(m_fileName).arg(writer.errorString()));
+        m_image = QImage();
+        m_state->inFlight.release();
+    }
+private:
+    ExportState* m_state;
+    QImage m_image;
+    QString m_fileName;
+    QByteArray m_format;
+    int m_quality;
+};
+
+// PackBits (TIFF compression 32773); every row is packed on its own.
+void appendPackBits(QByteArray& out, const uchar* data, int length)
+{
+    int i = 0;
+    while (i < length){
+        int run = 1;
+        while (i + run < length && run < 128 && data[i + run] == data[i]) ++run;
+        if (run > 1){
+            out.append(char(1 - run));
+            out.append(char(data[i]));
+            i += run;
+        } else {
+            int start = i;
+            int count = 0;
+            while (i < length && count < 128){
+                if (i + 2 < length && data[i] == data[i + 1] && data[i] == data[i + 2]) break;
+                ++i;
+                ++count;
+            }
+            out.append(char(count - 1));
+            out.append(reinterpret_cast<const char*>(data + start), count);
+        }
+    }
+}
+
+class EncodeTiffPageTask : public QRunnable{
+public:
+    EncodeTiffPageTask(ExportState* state, const QImage& image, int pageIndex)
+        : m_state(state), m_image(image), m_pageIndex(pageIndex){}
+    void run()
+    {
+        EncodedPage page;
+        page.size = m_image.size();
+        QImage rgb = m_image.convertToFormat(QImage::Format_RGB888);
+        m_image = QImage();
+        page.strip.reserve(rgb.width() * rgb.height());
+        for (int y = 0; y < rgb.height(); ++y)
+            appendPackBits(page.strip, rgb.constScanLine(y), rgb.width() * 3);
+        QMutexLocker locker(&m_state->mutex);
+        m_state->encodedPages.insert(m_pageIndex, page);
+        m_state->encoded.wakeAll();
+    }
+private:
+    ExportState* m_state;
+    QImage m_image;
+    int m_pageIndex;
+};
+
+// Baseline RGB TIFF written page by page: every page is appended as its strip
+// followed by its IFD, and the previous IFD is then linked to it.
+class TiffWriter{
+public:
+    TiffWriter(): m_nextIfdOffsetPos(4){}
+    bool open(const QString& fileName);
+    bool addPage(const EncodedPage& page, int dpi, int pageNumber, int pageCount);
+    void close(){ m_file.close(); }
+    QString errorString() const { return m_error.isEmpty() ? m_file.errorString() : m_error; }
+private:
+    enum FieldType{Short = 3, Long = 4, Rational = 5};
+    void writeEntry(QDataStream& stream, quint16 tag, FieldType type, quint32 count, quint32 value);
+private:
+    QFile m_file;
+    qint64 m_nextIfdOffsetPos;
+    QString m_error;
+};
+
+bool TiffWriter::open(const QString &fileName)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint8('I') << quint8('I') << quint16(42) << quint32(0);
+    m_nextIfdOffsetPos = 4;
+    return stream.status() == QDataStream::Ok;
+}
+
+void TiffWriter::writeEntry(QDataStream &stream, quint16 tag, FieldType type, quint32 count, quint32 value)
+{
+    stream << tag << quint16(type) << count << value;
+}
+
+bool TiffWriter::addPage(const EncodedPage &page, int dpi, int pageNumber, int pageCount)
+{
+    const quint16 entryCount = 15;
+    qint64 stripOffset = m_file.size();
+    qint64 extraOffset = stripOffset + page.strip.size() + page.strip.size() % 2;
+    qint64 ifdOffset = extraOffset + 24;
+    qint64 nextIfdOffsetPos = ifdOffset + 2 + entryCount * 12;
+    if (nextIfdOffsetPos + 4 > Q_INT64_C(0xFFFFFFFF)){
+        m_error = QObject::tr("TIFF file exceeds 4 GB");
+        return false;
+    }
+
+    m_file.seek(stripOffset);
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(page.strip.constData(), page.strip.size());
+    if (page.strip.size() % 2) stream << quint8(0);
+    // BitsPerSample values and padding, then X and Y resolution
+    stream << quint16(8) << quint16(8) << quint16(8) << quint16(0);
+    stream << quint32(dpi) << quint32(1) << quint32(dpi) << quint32(1);
+
+    stream << entryCount;
+    writeEntry(stream, 254, Long, 1, 2);                     // NewSubfileType: page
+    writeEntry(stream, 256, Long, 1, page.size.width());     // ImageWidth
+    writeEntry(stream, 257, Long, 1, page.size.height());    // ImageLength
+    writeEntry(stream, 258, Short, 3, extraOffset);          // BitsPerSample
+    writeEntry(stream, 259, Short, 1, 32773);                // Compression: PackBits
+    writeEntry(stream, 262, Short, 1, 2);                    // PhotometricInterpretation: RGB
+    writeEntry(stream, 273, Long, 1, stripOffset);           // StripOffsets
+    writeEntry(stream, 277, Short, 1, 3);                    // SamplesPerPixel
+    writeEntry(stream, 278, Long, 1, page.size.height());    // RowsPerStrip
+    writeEntry(stream, 279, Long, 1, page.strip.size());     // StripByteCounts
+    writeEntry(stream, 282, Rational, 1, extraOffset + 8);   // XResolution
+    writeEntry(stream, 283, Rational, 1, extraOffset + 16);  // YResolution
+    writeEntry(stream, 284, Short, 1, 1);                    // PlanarConfiguration: contiguous
+    writeEntry(stream, 296, Short, 1, 2);                    // ResolutionUnit: inch
+    writeEntry(stream, 297, Short, 2, quint32(pageNumber) | (quint32(pageCount) << 16)); // PageNumber
+    stream << quint32(0);
+
+    m_file.seek(m_nextIfdOffsetPos);
+    stream << quint32(ifdOffset);
+    m_nextIfdOffsetPos = nextIfdOffsetPos;
+    return stream.status() == QDataStream::Ok;
+}
+
+// Appends encoded pages to the TIFF file in page order; with wait set it
+// blocks until the next page is encoded.
+void writeEncodedPages(ExportState& state, TiffWriter& tiff, int& nextPage, int pageCount, int dpi, bool wait)
+{
+    while (true){
+        EncodedPage page;
+        {
+            QMutexLocker locker(&state.mutex);
+            while (wait && !state.encodedPages.contains(nextPage))
+                state.encoded.wait(&state.mutex);
+            if (!state.encodedPages.contains(nextPage)) return;
+            page = state.encodedPages.take(nextPage);
+        }
+        if (!tiff.addPage(page, dpi, nextPage, pageCount))
+            state.setError(tiff.errorString());
+        state.inFlight.release();
+        ++nextPage;
+        wait = false;
+    }
+}
+
+QSize pageImageSize(LimeReport::PageItemDesignIntf* page, int dpi)
+{
+    QSizeF size = page->rect().size() / LimeReport::Const::mmFACTOR / 25.4 * dpi;
+    return QSize(qMax(qRound(size.width()), 1), qMax(qRound(size.height()), 1));
+}
+
+// Writer format for a format name or file suffix, empty when it is not supported.
+QByteArray imageFormat(const QString& name)
+{
+    QString format = name.toLower();
+    if (format == "jpg" || format == "jpeg") return "jpeg";
+    if (format == "tif" || format == "tiff") return "tiff";
+    if (format == "png") return "png";
+    return QByteArray();
+}
+
+// The file suffix is kept when it names format; otherwise the format's
+// extension is appended, so "report.dat" exported as png gives "report.dat.png".
+QString pageFileName(const QFileInfo& fileInfo, const QByteArray& format, int pageIndex, int pageCount)
+{
+    QString baseName = fileInfo.completeBaseName();
+    QString suffix = fileInfo.suffix();
+    if (imageFormat(suffix) != format){
+        baseName = fileInfo.fileName();
+        suffix = format == "jpeg" ? QString("jpg") : QString::fromLatin1(format);
+    }
+    if (pageCount == 1)
+        return QDir(fileInfo.path()).filePath(baseName + "." + suffix);
+    int digits = QString::number(pageCount).length();
+    return QDir(fileInfo.path()).filePath(
+        QString("%1_%2.%3").arg(baseName)
+                           .arg(pageIndex + 1, digits, 10, QChar('0'))
+                           .arg(suffix)
+    );
+}
+
+}
+
+namespace LimeReport{
+
+ImageExporter::ImageExporter(ReportEnginePrivate *parent) : QObject(parent), m_reportEngine(parent)
+{}
+
+// Pages are painted one by one on the calling thread, the graphics scene is
+// not thread-safe; encoding and writing, the expensive part, run on a thread
+// pool. At most threads * IMAGE_EXPORT_BUFFERS_PER_THREAD painted pages are
+// held in memory.
+bool ImageExporter::exportPages(ReportPages pages, const QString &fileName, const QMap<QString, QVariant> &params)
+{
+    if (fileName.isEmpty()) return false;
+
+    QFileInfo fileInfo(fileName);
+    QByteArray format = imageFormat(params.value("format", fileInfo.suffix()).toString());
+    if (format.isEmpty()) format = "png";
+    bool multiPageTiff = format == "tiff";
+    int dpi = params.value("dpi", Const::IMAGE_EXPORT_DPI).toInt();
+    if (dpi <= 0) dpi = Const::IMAGE_EXPORT_DPI;
+    int quality = params.value("quality", -1).toInt();
+    int threads = qMax(params.value("threads", QThread::idealThreadCount()).toInt(), 1);
+
+    QStringList fileNames;
+    TiffWriter tiff;
+    if (multiPageTiff){
+        fileNames.append(pageFileName(fileInfo, format, 0, 1));
+        if (!tiff.open(fileNames.first())){
+            qWarning() << fileNames.first() << tiff.errorString();
+            return false;
+        }
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    ExportState state(threads * Const::IMAGE_EXPORT_BUFFERS_PER_THREAD);
+    int nextPage = 0;
+
+    for (int i = 0; i < pages.count(); ++i){
+        if (multiPageTiff){
+            while (!state.isFailed() && !state.inFlight.tryAcquire())
+                writeEncodedPages(state, tiff, nextPage, pages.count(), dpi, true);
+        } else {
+            state.inFlight.acquire();
+        }
+        if (state.isFailed()) break;
+
+        PageItemDesignIntf* page = pages.at(i).data();
+        QImage image = PageDesignIntf::renderPageToImage(page, pageImageSize(page, dpi));
+        int dotsPerMeter = qRound(dpi / 0.0254);
+        image.setDotsPerMeterX(dotsPerMeter);
+        image.setDotsPerMeterY(dotsPerMeter);
+        if (multiPageTiff){
+            pool.start(new EncodeTiffPageTask(&state, image, i));
+        } else {
+            fileNames.append(pageFileName(fileInfo, format, i, pages.count()));
+            pool.start(new WriteImageTask(&state, image, fileNames.last(), format, quality));
+        }
+    }
+
+    pool.waitForDone();
+    if (multiPageTiff){
+        if (!state.isFailed())
+            writeEncodedPages(state, tiff, nextPage, pages.count(), dpi, false);
+        tiff.close();
+    }
+
+    if (state.isFailed()){
+        qWarning() << state.error();
+        return false;
+    }
+    if (m_reportEngine) m_reportEngine->emitExportedToImage(fileNames);
+    return true;
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef LRIMAGEEXPORTER_H
+#define LRIMAGEEXPORTER_H
+
+#include <QObject>
+#include "lrexporterintf.h"
+
+namespace LimeReport{
+class ReportEnginePrivate;
+
+// Raster export of report pages. Parameters:
+//   format  - "png", "jpeg" or "tiff", the file suffix by default
+//   dpi     - output resolution, Const::IMAGE_EXPORT_DPI by default
+//   quality - JPEG/PNG encoder quality, -1 for the format default
+//   threads - encoder threads, QThread::idealThreadCount() by default
+// PNG and JPEG pages go to "<name>_<page>.<suffix>" files, TIFF pages are
+// appended to one multi-page file. The suffix is the format's extension when
+// the file name does not already end with one. The written files are reported
+// through ReportEngine::exportedToImage().
+class ImageExporter : public QObject, public ReportExporterInterface
+{
+    Q_OBJECT
+public:
+    explicit ImageExporter(ReportEnginePrivate *parent = NULL);
+    // ReportExporterInterface interface
+    bool exportPages(ReportPages pages, const QString &fileName, const QMap<QString, QVariant> &params);
+    QString exporterName()
+    {
+        return "IMAGE";
+    }
+    QString exporterFileExt()
+    {
+        return "png";
+    }
+    QString hint()
+    {
+        return tr("Export to image");
+    }
+private:
+    ReportEnginePrivate* m_reportEngine;
+};
+
+} //namespace LimeReport
+
+#endif // LRIMAGEEXPORTER_H
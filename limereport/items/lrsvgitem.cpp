@@ -3,6 +3,9 @@
 #include "lrimageitemeditor.h"
 #include "lrpagedesignintf.h"
 #include <QtSvg>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QMutex>
 
 namespace{
     const QString xmlTag = "SVGItem";
@@ -15,6 +18,66 @@ namespace{
 }
 
 namespace LimeReport{
+
+// Items on pages rendered by different threads may share an entry,
+// so the renderer and the images are only used under mutex.
+struct SVGRenderCacheEntry{
+    SVGRenderCacheEntry():images(Const::SVG_RASTER_CACHE_SIZES){}
+    QMutex mutex;
+    QSvgRenderer renderer;
+    // rasterized images keyed by target size, see imageKey()
+    QCache<quint64, QImage> images;
+};
+
+namespace {
+
+typedef QHash<QByteArray, QWeakPointer<SVGRenderCacheEntry> > SVGRenderCache;
+
+SVGRenderCache& svgRenderCache()
+{
+    static SVGRenderCache cache;
+    return cache;
+}
+
+QMutex& svgRenderCacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+quint64 imageKey(const QSize& size)
+{
+    return (quint64(quint32(size.width())) << 32) | quint32(size.height());
+}
+
+QSharedPointer<SVGRenderCacheEntry> findSVGRenderCacheEntry(const QByteArray& image)
+{
+    QMutexLocker locker(&svgRenderCacheMutex());
+    SVGRenderCache& cache = svgRenderCache();
+    QByteArray key = QCryptographicHash::hash(image, QCryptographicHash::Md5) + QByteArray::number(image.size());
+    QSharedPointer<SVGRenderCacheEntry> entry = cache.value(key).toStrongRef();
+    if (!entry){
+        if (cache.size() >= Const::SVG_RENDER_CACHE_LIMIT){
+            SVGRenderCache::iterator it = cache.begin();
+            while (it != cache.end()){
+                if (it.value().isNull()) it = cache.erase(it);
+                else ++it;
+            }
+        }
+        entry = QSharedPointer<SVGRenderCacheEntry>(new SVGRenderCacheEntry);
+        entry->renderer.load(image);
+        cache.insert(key, entry);
+    }
+    return entry;
+}
+
+bool isRasterDevice(QPaintDevice* device)
+{
+    return device && (device->devType() == QInternal::Image || device->devType() == QInternal::Pixmap);
+}
+
+} // namespace
+
 SVGItem::SVGItem(QObject *owner, QGraphicsItem *parent)
     :ItemDesignIntf(xmlTag,owner,parent)
 {
@@ -35,9 +98,31 @@ void SVGItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, Q
         painter->drawText(rect().adjusted(4,4,-4,-4), Qt::AlignCenter, text );
     }
     else if (!m_image.isEmpty()){
-        QSvgRenderer render;
-        render.load(m_image);
-        render.render(painter, option->rect);
+        SVGRenderCacheEntry* cache = renderCache();
+        QTransform transform = painter->worldTransform();
+        QSize size = transform.mapRect(QRectF(option->rect)).toAlignedRect().size();
+        if (isRasterDevice(painter->device()) && transform.type() <= QTransform::TxScale && !size.isEmpty()){
+            // raster outputs reuse the images rasterized for recent target sizes
+            QImage image;
+            {
+                QMutexLocker locker(&cache->mutex);
+                QImage* cached = cache->images.object(imageKey(size));
+                if (cached){
+                    image = *cached;
+                } else {
+                    image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+                    image.fill(Qt::transparent);
+                    QPainter imagePainter(&image);
+                    cache->renderer.render(&imagePainter, QRectF(QPointF(0,0), size));
+                    imagePainter.end();
+                    cache->images.insert(imageKey(size), new QImage(image));
+                }
+            }
+            painter->drawImage(QRectF(option->rect), image);
+        } else {
+            QMutexLocker locker(&cache->mutex);
+            cache->renderer.render(painter, option->rect);
+        }
     }
     ItemDesignIntf::paint(painter,option,widget);
     painter->restore();
@@ -114,9 +199,17 @@ void SVGItem::updateItemSize(DataSourceManager *dataManager, RenderPass pass, in
                 m_image = data.value<QByteArray>();
             }
         }
+        m_renderCache.clear();
     }
 }
 
+SVGRenderCacheEntry* SVGItem::renderCache()
+{
+    if (!m_renderCache)
+        m_renderCache = findSVGRenderCacheEntry(m_image);
+    return m_renderCache.data();
+}
+
 QByteArray SVGItem::imageFromResource(QString resourcePath)
 {
     QFile file(resourcePath);
@@ -155,6 +248,7 @@ void SVGItem::setResourcePath(const QString &resourcePath)
         QFile file(resourcePath);
         if (file.open(QIODevice::ReadOnly)){
             m_image = file.readAll();
+            m_renderCache.clear();
         }
         update();
         notify("resourcePath", oldValue, resourcePath);
@@ -171,6 +265,7 @@ void SVGItem::setImage(const QByteArray &image)
     if (m_image != image){
         QByteArray oldValue = m_image;
         m_image = image;
+        m_renderCache.clear();
         update();
         notify("image", oldValue, image);
     }
@@ -1,10 +1,14 @@
 #ifndef SVGITEM_H
 #define SVGITEM_H
 
+#include <QSharedPointer>
 #include "lritemdesignintf.h"
 #include "lreditableimageitemintf.h"
 
 namespace LimeReport{
+
+struct SVGRenderCacheEntry;
+
 class SVGItem: public ItemDesignIntf, public IEditableImageItem
 {
     Q_OBJECT
@@ -42,12 +46,15 @@ protected:
     BaseDesignIntf *createSameTypeItem(QObject *owner, QGraphicsItem *parent);
     void updateItemSize(DataSourceManager *dataManager, RenderPass pass, int maxHeight);
     QByteArray imageFromResource(QString resourcePath);
+    SVGRenderCacheEntry* renderCache();
 private:
     QString m_resourcePath;
     QByteArray m_image;
     QString m_datasource;
     QString m_field;
     QString m_variable;
+    // parsed renderer shared by all items holding the same SVG content
+    QSharedPointer<SVGRenderCacheEntry> m_renderCache;
 public:
 
 };
@@ -812,11 +812,14 @@ void TextItem::setAlignment(Qt::Alignment value)
 void TextItem::expandContent(DataSourceManager* dataManager, RenderPass pass)
 {
     QString context=content();
-    foreach (QString variableName, dataManager->variableNamesByRenderPass(SecondPass)) {
-        QRegExp rx(QString(Const::NAMED_VARIABLE_RX).arg(variableName));
-        if (context.contains(rx) && pass == FirstPass){
-            backupContent();
-            break;
+    if (pass == FirstPass){
+        foreach (const QString& variableName, dataManager->variableNamesByRenderPass(SecondPass)) {
+            if (!context.contains(variableName)) continue;
+            QRegExp rx(QString(Const::NAMED_VARIABLE_RX).arg(variableName));
+            if (context.contains(rx)){
+                backupContent();
+                break;
+            }
         }
     }
 
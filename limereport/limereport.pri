@@ -26,6 +26,7 @@ SOURCES += \
     $$REPORT_PATH/serializators/lrxmlbasetypesserializators.cpp \
     $$REPORT_PATH/serializators/lrxmlreader.cpp \
     $$REPORT_PATH/serializators/lrxmlwriter.cpp \
+    $$REPORT_PATH/serializators/lrserializationschema.cpp \
     $$REPORT_PATH/scripteditor/lrscripteditor.cpp \
     $$REPORT_PATH/scripteditor/lrcodeeditor.cpp \
     $$REPORT_PATH/scripteditor/lrscripthighlighter.cpp \
@@ -56,6 +57,12 @@ SOURCES += \
     $$REPORT_PATH/lrglobal.cpp \
     $$REPORT_PATH/lritemdesignintf.cpp \
     $$REPORT_PATH/lrdatadesignintf.cpp \
+    $$REPORT_PATH/lrcsvdatasource.cpp \
+    $$REPORT_PATH/lrcolumnardatasource.cpp \
+    $$REPORT_PATH/lrqueryprefetch.cpp \
+    $$REPORT_PATH/lrqueryresultcache.cpp \
+    $$REPORT_PATH/lrsorteddatasource.cpp \
+    $$REPORT_PATH/lrrenderprofiler.cpp \
     $$REPORT_PATH/lrbasedesignintf.cpp \
     $$REPORT_PATH/lrreportengine.cpp \
     $$REPORT_PATH/lrdatasourcemanager.cpp \
@@ -63,6 +70,7 @@ SOURCES += \
     $$REPORT_PATH/lrscriptenginemanager.cpp \
     $$REPORT_PATH/lrpreviewreportwindow.cpp \
     $$REPORT_PATH/lrpreviewreportwidget.cpp \
+    $$REPORT_PATH/lrpreviewthumbnails.cpp \
     $$REPORT_PATH/lrgraphicsviewzoom.cpp \
     $$REPORT_PATH/lrvariablesholder.cpp \
     $$REPORT_PATH/lrgroupfunctions.cpp \
@@ -73,7 +81,9 @@ SOURCES += \
     $$REPORT_PATH/lrcolorindicator.cpp \
     $$REPORT_PATH/lrreporttranslation.cpp \
     $$REPORT_PATH/exporters/lrpdfexporter.cpp \
-    $$REPORT_PATH/lrpreparedpages.cpp
+    $$REPORT_PATH/exporters/lrimageexporter.cpp \
+    $$REPORT_PATH/lrpreparedpages.cpp \
+    $$REPORT_PATH/lrtemplatecache.cpp
 
 
 contains(CONFIG, staticlib){
@@ -108,6 +118,7 @@ HEADERS += \
     $$REPORT_PATH/serializators/lrxmlbasetypesserializators.h \
     $$REPORT_PATH/serializators/lrxmlreader.h \
     $$REPORT_PATH/serializators/lrxmlwriter.h \
+    $$REPORT_PATH/serializators/lrserializationschema.h \
     $$REPORT_PATH/scripteditor/lrscripteditor.h \
     $$REPORT_PATH/scripteditor/lrcodeeditor.h \
     $$REPORT_PATH/scripteditor/lrscripthighlighter.h \
@@ -136,6 +147,13 @@ HEADERS += \
     $$REPORT_PATH/lrbandsmanager.h \
     $$REPORT_PATH/lrglobal.h \
     $$REPORT_PATH/lrdatadesignintf.h \
+    $$REPORT_PATH/lrcsvdatasource.h \
+    $$REPORT_PATH/lrcolumnardatasource.h \
+    $$REPORT_PATH/lrcolumnardatatable.h \
+    $$REPORT_PATH/lrqueryprefetch.h \
+    $$REPORT_PATH/lrqueryresultcache.h \
+    $$REPORT_PATH/lrsorteddatasource.h \
+    $$REPORT_PATH/lrrenderprofiler.h \
     $$REPORT_PATH/lrcollection.h \
     $$REPORT_PATH/lrpagedesignintf.h \
     $$REPORT_PATH/lrreportengine_p.h \
@@ -144,6 +162,7 @@ HEADERS += \
     $$REPORT_PATH/lrpreviewreportwindow.h \
     $$REPORT_PATH/lrpreviewreportwidget.h \
     $$REPORT_PATH/lrpreviewreportwidget_p.h \
+    $$REPORT_PATH/lrpreviewthumbnails.h \
     $$REPORT_PATH/lrgraphicsviewzoom.h \
     $$REPORT_PATH/lrbasedesignintf.h \
     $$REPORT_PATH/lritemdesignintf.h \
@@ -167,8 +186,10 @@ HEADERS += \
     $$REPORT_PATH/lrexporterintf.h \
     $$REPORT_PATH/lrexportersfactory.h \	
     $$REPORT_PATH/exporters/lrpdfexporter.h \
+    $$REPORT_PATH/exporters/lrimageexporter.h \
     $$REPORT_PATH/lrpreparedpages.h \
-    $$REPORT_PATH/lrpreparedpagesintf.h 
+    $$REPORT_PATH/lrpreparedpagesintf.h \
+    $$REPORT_PATH/lrtemplatecache.h
 
 contains(CONFIG, staticlib){
     HEADERS += $$REPORT_PATH/lrfactoryinitializer.h
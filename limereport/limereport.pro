@@ -36,6 +36,7 @@ EXTRA_FILES += \
     $$PWD/lrglobal.h \
     $$PWD/lrdatasourceintf.h \
     $$PWD/lrdatasourcemanagerintf.h \
+    $$PWD/lrcolumnardatatable.h \
     $$PWD/lrreportengine.h \
     $$PWD/lrscriptenginemanagerintf.h \
     $$PWD/lrcallbackdatasourceintf.h \
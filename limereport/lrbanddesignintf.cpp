@@ -1174,6 +1174,16 @@ DataBandDesignIntf::DataBandDesignIntf(BandDesignIntf::BandsType bandType, QStri
 {
 }
 
+void DataBandDesignIntf::setSortBy(const QString &sortBy)
+{
+    if (m_sortBy != sortBy){
+        QString oldValue = m_sortBy;
+        m_sortBy = sortBy;
+        if (!isLoading())
+            notify("sortBy", oldValue, sortBy);
+    }
+}
+
 BandNameLabel::BandNameLabel(BandDesignIntf *band, QGraphicsItem *parent)
     :QGraphicsItem(parent),m_rect(5,5,30,30),m_band(band)
 {
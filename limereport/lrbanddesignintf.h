@@ -339,8 +339,13 @@ private:
 class DataBandDesignIntf : public BandDesignIntf{
     Q_OBJECT
     Q_PROPERTY(QString datasource READ datasourceName WRITE setDataSourceName )
+    Q_PROPERTY(QString sortBy READ sortBy WRITE setSortBy)
 public:
     DataBandDesignIntf(BandsType bandType, QString xmlTypeName, QObject* owner = 0, QGraphicsItem* parent=0);
+    QString sortBy() const { return m_sortBy; }
+    void setSortBy(const QString& sortBy);
+private:
+    QString m_sortBy;
 };
 
 bool bandIndexLessThen(const BandDesignIntf* b1, const BandDesignIntf* b2);
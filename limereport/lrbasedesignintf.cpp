@@ -1614,7 +1614,9 @@ QList<BaseDesignIntf*> BaseDesignIntf::allChildBaseItems()
 
 BaseDesignIntf *BaseDesignIntf::childByName(const QString &name)
 {
-    foreach(BaseDesignIntf* item, childBaseItems()){
+    ChildBaseItemsIterator it(this);
+    while (it.hasNext()){
+        BaseDesignIntf* item = it.next();
         if (item->objectName().compare(name,Qt::CaseInsensitive)==0){
             return item;
         } else {
@@ -479,6 +479,31 @@ signals:
     void afterRender();
 };
 
+// Java-style iterator over the BaseDesignIntf children of an item;
+// unlike childBaseItems() it does not build a new list.
+class ChildBaseItemsIterator{
+public:
+    explicit ChildBaseItemsIterator(const BaseDesignIntf* item)
+        : m_items(item->childItems()), m_index(0), m_next(0){}
+    bool hasNext()
+    {
+        while (!m_next && m_index < m_items.size())
+            m_next = dynamic_cast<BaseDesignIntf*>(m_items.at(m_index++));
+        return m_next != 0;
+    }
+    BaseDesignIntf* next()
+    {
+        hasNext();
+        BaseDesignIntf* result = m_next;
+        m_next = 0;
+        return result;
+    }
+private:
+    const QList<QGraphicsItem*> m_items;
+    int m_index;
+    BaseDesignIntf* m_next;
+};
+
 class BookmarkContainerDesignIntf: public BaseDesignIntf{
     Q_OBJECT
 public:
@@ -1,21 +1,36 @@
 #ifndef LRVIRTUALDATASOURCEINTF
 #define LRVIRTUALDATASOURCEINTF
 #include <QObject>
+#include <QVariant>
+#include <QVector>
+#include <QStringList>
 namespace LimeReport {
 
 struct CallbackInfo{
-    enum DataType{IsEmpty, HasNext, ColumnHeaderData, ColumnData, ColumnCount, RowCount};
+    enum DataType{IsEmpty, HasNext, ColumnHeaderData, ColumnData, ColumnCount, RowCount, RowBlock};
     enum ChangePosType{First, Next};
     DataType dataType;
     int index;
     QString columnName;
+    // RowBlock only: number of rows requested starting at index and the
+    // columns expected in every returned row, in this order
+    int blockSize;
+    QStringList columnNames;
 };
 
 class ICallbackDatasource :public QObject{
     Q_OBJECT
+public:
+    // Opt-in bulk fetch: when rows > 0 and getCallbackDataBlock is connected,
+    // rows are requested in blocks of this size instead of cell by cell
+    virtual void setBlockSize(int rows) = 0;
+    virtual int blockSize() const = 0;
 signals:
     void getCallbackData(const LimeReport::CallbackInfo& info, QVariant& data);
     void changePos(const LimeReport::CallbackInfo::ChangePosType& type, bool& result);
+    // Fill rows with up to info.blockSize rows starting at row info.index,
+    // each row holding the values of info.columnNames; fewer rows mean the end of data
+    void getCallbackDataBlock(const LimeReport::CallbackInfo& info, QVector<QVariantList>& rows);
 };
 
 }
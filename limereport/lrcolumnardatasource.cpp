@@ -0,0 +1,303 @@
+#include "lrcolumnardatasource.h"
+
+#include <QObject>
+
+namespace LimeReport{
+
+ColumnarDataTable::ColumnarDataTable()
+    : m_rowCount(0)
+{}
+
+bool ColumnarDataTable::checkColumn(const QString &name, int size, const QBitArray &nulls)
+{
+    if (name.isEmpty() || m_columnIndex.contains(name)){
+        m_lastError = QObject::tr("Column name \"%1\" is empty or already exists").arg(name);
+        return false;
+    }
+    if (!m_columns.isEmpty() && size != m_rowCount){
+        m_lastError = QObject::tr("Column \"%1\" has %2 rows, expected %3").arg(name).arg(size).arg(m_rowCount);
+        return false;
+    }
+    if (!nulls.isEmpty() && nulls.size() != size){
+        m_lastError = QObject::tr("Null bitmap of column \"%1\" does not match its size").arg(name);
+        return false;
+    }
+    return true;
+}
+
+void ColumnarDataTable::appendColumn(const Column &column)
+{
+    m_columnIndex.insert(column.name, m_columns.count());
+    m_columns.append(column);
+}
+
+bool ColumnarDataTable::addColumn(const QString &name, const QVector<qint64> &values, const QBitArray &nulls)
+{
+    if (!checkColumn(name, values.size(), nulls)) return false;
+    Column column;
+    column.name = name;
+    column.type = Int64Column;
+    column.nulls = nulls;
+    column.int64Values = values;
+    m_rowCount = values.size();
+    appendColumn(column);
+    return true;
+}
+
+bool ColumnarDataTable::addColumn(const QString &name, const QVector<double> &values, const QBitArray &nulls)
+{
+    if (!checkColumn(name, values.size(), nulls)) return false;
+    Column column;
+    column.name = name;
+    column.type = DoubleColumn;
+    column.nulls = nulls;
+    column.doubleValues = values;
+    m_rowCount = values.size();
+    appendColumn(column);
+    return true;
+}
+
+bool ColumnarDataTable::addColumn(const QString &name, const QVector<QString> &values, const QBitArray &nulls)
+{
+    if (!checkColumn(name, values.size(), nulls)) return false;
+    Column column;
+    column.name = name;
+    column.type = StringColumn;
+    column.nulls = nulls;
+    column.stringValues = values;
+    m_rowCount = values.size();
+    appendColumn(column);
+    return true;
+}
+
+bool ColumnarDataTable::addColumn(const QString &name, const QVector<QDate> &values, const QBitArray &nulls)
+{
+    if (!checkColumn(name, values.size(), nulls)) return false;
+    Column column;
+    column.name = name;
+    column.type = DateColumn;
+    column.nulls = nulls;
+    column.dateValues = values;
+    m_rowCount = values.size();
+    appendColumn(column);
+    return true;
+}
+
+bool ColumnarDataTable::addColumn(const QString &name, const QVector<QDateTime> &values, const QBitArray &nulls)
+{
+    if (!checkColumn(name, values.size(), nulls)) return false;
+    Column column;
+    column.name = name;
+    column.type = DateTimeColumn;
+    column.nulls = nulls;
+    column.dateTimeValues = values;
+    m_rowCount = values.size();
+    appendColumn(column);
+    return true;
+}
+
+bool ColumnarDataTable::addColumn(const QString &name, const QVector<QByteArray> &values, const QBitArray &nulls)
+{
+    if (!checkColumn(name, values.size(), nulls)) return false;
+    Column column;
+    column.name = name;
+    column.type = BlobColumn;
+    column.nulls = nulls;
+    column.blobValues = values;
+    m_rowCount = values.size();
+    appendColumn(column);
+    return true;
+}
+
+void ColumnarDataTable::clear()
+{
+    m_columns.clear();
+    m_columnIndex.clear();
+    m_rowCount = 0;
+    m_lastError.clear();
+}
+
+QString ColumnarDataTable::columnName(int column) const
+{
+    if (column < 0 || column >= m_columns.count()) return QString();
+    return m_columns.at(column).name;
+}
+
+ColumnarDataTable::ColumnType ColumnarDataTable::columnType(int column) const
+{
+    if (column < 0 || column >= m_columns.count()) return StringColumn;
+    return m_columns.at(column).type;
+}
+
+int ColumnarDataTable::columnIndex(const QString &name) const
+{
+    int index = m_columnIndex.value(name, -1);
+    if (index != -1) return index;
+    for (int i = 0; i < m_columns.count(); ++i){
+        if (m_columns.at(i).name.compare(name, Qt::CaseInsensitive) == 0)
+            return i;
+    }
+    return -1;
+}
+
+bool ColumnarDataTable::isNull(int row, int column) const
+{
+    if (row < 0 || row >= m_rowCount || column < 0 || column >= m_columns.count()) return true;
+    const QBitArray& nulls = m_columns.at(column).nulls;
+    return !nulls.isEmpty() && nulls.testBit(row);
+}
+
+QVariant ColumnarDataTable::value(int row, int column) const
+{
+    if (isNull(row, column)) return QVariant();
+    const Column& col = m_columns.at(column);
+    switch (col.type) {
+    case Int64Column:
+        return col.int64Values.at(row);
+    case DoubleColumn:
+        return col.doubleValues.at(row);
+    case StringColumn:
+        return col.stringValues.at(row);
+    case DateColumn:
+        return col.dateValues.at(row);
+    case DateTimeColumn:
+        return col.dateTimeValues.at(row);
+    case BlobColumn:
+        return col.blobValues.at(row);
+    }
+    return QVariant();
+}
+
+ColumnarTableModel::ColumnarTableModel(const ColumnarDataTable *table)
+    : m_table(table)
+{}
+
+int ColumnarTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_table->rowCount();
+}
+
+int ColumnarTableModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_table->columnCount();
+}
+
+QVariant ColumnarTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+    return m_table->value(index.row(), index.column());
+}
+
+QVariant ColumnarTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return m_table->columnName(section);
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+ColumnarDataSource::ColumnarDataSource(const ColumnarDataTable &table)
+    : m_table(table), m_curRow(-1), m_model(0)
+{}
+
+ColumnarDataSource::~ColumnarDataSource()
+{
+    delete m_model;
+}
+
+int ColumnarDataSource::currentRow()
+{
+    if (eof()) return m_curRow-1;
+    if (bof()) return m_curRow+1;
+    return m_curRow;
+}
+
+bool ColumnarDataSource::next()
+{
+    if (m_curRow < m_table.rowCount()){
+        if (bof()) m_curRow++;
+        m_curRow++;
+        return true;
+    } else return false;
+}
+
+bool ColumnarDataSource::hasNext()
+{
+    return m_curRow < m_table.rowCount()-1;
+}
+
+bool ColumnarDataSource::prior()
+{
+    if (m_curRow > -1){
+        if (eof()) m_curRow--;
+        m_curRow--;
+        return true;
+    } else return false;
+}
+
+void ColumnarDataSource::first()
+{
+    m_curRow = 0;
+}
+
+void ColumnarDataSource::last()
+{
+    m_curRow = m_table.rowCount()-1;
+}
+
+bool ColumnarDataSource::bof()
+{
+    return (m_curRow == -1) || (m_table.rowCount() == 0);
+}
+
+bool ColumnarDataSource::eof()
+{
+    return (m_curRow == m_table.rowCount()) || (m_table.rowCount() == 0);
+}
+
+QVariant ColumnarDataSource::data(const QString &columnName)
+{
+    return m_table.value(currentRow(), m_table.columnIndex(columnName));
+}
+
+QVariant ColumnarDataSource::dataByRowIndex(const QString &columnName, int rowIndex)
+{
+    return m_table.value(rowIndex, m_table.columnIndex(columnName));
+}
+
+QVariant ColumnarDataSource::dataByKeyField(const QString &columnName, const QString &keyColumnName, QVariant keyData)
+{
+    int keyColumn = m_table.columnIndex(keyColumnName);
+    int column = m_table.columnIndex(columnName);
+    if (keyColumn == -1 || column == -1) return QVariant();
+    for (int i = 0; i < m_table.rowCount(); ++i){
+        if (m_table.value(i, keyColumn) == keyData)
+            return m_table.value(i, column);
+    }
+    return QVariant();
+}
+
+int ColumnarDataSource::columnCount()
+{
+    return m_table.columnCount();
+}
+
+QString ColumnarDataSource::columnNameByIndex(int columnIndex)
+{
+    return m_table.columnName(columnIndex);
+}
+
+int ColumnarDataSource::columnIndexByName(QString name)
+{
+    return m_table.columnIndex(name);
+}
+
+QAbstractItemModel *ColumnarDataSource::model()
+{
+    if (!m_model) m_model = new ColumnarTableModel(&m_table);
+    return m_model;
+}
+
+} // namespace LimeReport
@@ -0,0 +1,52 @@
+#ifndef LRCOLUMNARDATASOURCE_H
+#define LRCOLUMNARDATASOURCE_H
+
+#include <QAbstractTableModel>
+#include "lrdatasourceintf.h"
+#include "lrcolumnardatatable.h"
+
+namespace LimeReport{
+
+class ColumnarTableModel : public QAbstractTableModel{
+    Q_OBJECT
+public:
+    explicit ColumnarTableModel(const ColumnarDataTable* table);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+private:
+    const ColumnarDataTable* m_table;
+};
+
+class ColumnarDataSource : public IDataSource{
+public:
+    explicit ColumnarDataSource(const ColumnarDataTable& table);
+    ~ColumnarDataSource();
+    bool next();
+    bool hasNext();
+    bool prior();
+    void first();
+    void last();
+    bool bof();
+    bool eof();
+    QVariant data(const QString& columnName);
+    QVariant dataByRowIndex(const QString& columnName, int rowIndex);
+    QVariant dataByKeyField(const QString& columnName, const QString& keyColumnName, QVariant keyData);
+    int columnCount();
+    QString columnNameByIndex(int columnIndex);
+    int columnIndexByName(QString name);
+    bool isInvalid() const { return false; }
+    QString lastError(){ return ""; }
+    QAbstractItemModel* model();
+private:
+    int currentRow();
+private:
+    ColumnarDataTable m_table;
+    int m_curRow;
+    ColumnarTableModel* m_model;
+};
+
+} // namespace LimeReport
+
+#endif // LRCOLUMNARDATASOURCE_H
@@ -0,0 +1,62 @@
+#ifndef LRCOLUMNARDATATABLE_H
+#define LRCOLUMNARDATATABLE_H
+
+#include <QVector>
+#include <QString>
+#include <QBitArray>
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QVariant>
+#include "lrglobal.h"
+
+namespace LimeReport {
+
+// Typed in-memory table handed to IDataSourceManager::addColumnarData().
+// Columns are Qt containers and therefore implicitly shared: adding a column
+// does not copy its values as long as the caller does not modify its own
+// vector afterwards. A set bit in the optional nulls bitmap marks a null cell.
+class LIMEREPORT_EXPORT ColumnarDataTable{
+public:
+    enum ColumnType{Int64Column, DoubleColumn, StringColumn, DateColumn, DateTimeColumn, BlobColumn};
+    ColumnarDataTable();
+    bool addColumn(const QString& name, const QVector<qint64>& values, const QBitArray& nulls = QBitArray());
+    bool addColumn(const QString& name, const QVector<double>& values, const QBitArray& nulls = QBitArray());
+    bool addColumn(const QString& name, const QVector<QString>& values, const QBitArray& nulls = QBitArray());
+    bool addColumn(const QString& name, const QVector<QDate>& values, const QBitArray& nulls = QBitArray());
+    bool addColumn(const QString& name, const QVector<QDateTime>& values, const QBitArray& nulls = QBitArray());
+    bool addColumn(const QString& name, const QVector<QByteArray>& values, const QBitArray& nulls = QBitArray());
+    void clear();
+    int rowCount() const { return m_rowCount; }
+    int columnCount() const { return m_columns.count(); }
+    QString columnName(int column) const;
+    ColumnType columnType(int column) const;
+    int columnIndex(const QString& name) const;
+    bool isNull(int row, int column) const;
+    QVariant value(int row, int column) const;
+    QString lastError() const { return m_lastError; }
+private:
+    struct Column{
+        QString name;
+        ColumnType type;
+        QBitArray nulls;
+        QVector<qint64> int64Values;
+        QVector<double> doubleValues;
+        QVector<QString> stringValues;
+        QVector<QDate> dateValues;
+        QVector<QDateTime> dateTimeValues;
+        QVector<QByteArray> blobValues;
+    };
+    bool checkColumn(const QString& name, int size, const QBitArray& nulls);
+    void appendColumn(const Column& column);
+private:
+    QVector<Column> m_columns;
+    QHash<QString, int> m_columnIndex;
+    int m_rowCount;
+    QString m_lastError;
+};
+
+} // namespace LimeReport
+
+#endif // LRCOLUMNARDATATABLE_H
@@ -0,0 +1,408 @@
+#include "lrcsvdatasource.h"
+
+#include <cstring>
+
+namespace LimeReport{
+
+namespace {
+
+const int TYPE_INFERENCE_SAMPLE = 1000;
+
+bool isIntegerText(const char* text, int length)
+{
+    int pos = (length > 0 && text[0] == '-') ? 1 : 0;
+    int digits = length - pos;
+    if (digits <= 0 || digits > 18) return false;
+    if (digits > 1 && text[pos] == '0') return false;
+    for (; pos < length; ++pos)
+        if (text[pos] < '0' || text[pos] > '9') return false;
+    return true;
+}
+
+bool isDoubleText(const char* text, int length)
+{
+    int pos = (length > 0 && text[0] == '-') ? 1 : 0;
+    int intDigits = 0, fracDigits = 0;
+    bool point = false;
+    if (length - pos > 1 && text[pos] == '0' && text[pos+1] != '.') return false;
+    for (; pos < length; ++pos){
+        if (text[pos] == '.'){
+            if (point) return false;
+            point = true;
+        } else if (text[pos] >= '0' && text[pos] <= '9'){
+            if (point) ++fracDigits; else ++intDigits;
+        } else return false;
+    }
+    return intDigits > 0 && (!point || fracDigits > 0);
+}
+
+} // namespace
+
+CSVTableModel::CSVTableModel(CSVDataSource *dataSource)
+    : m_dataSource(dataSource)
+{}
+
+int CSVTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_dataSource->rowCount();
+}
+
+int CSVTableModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_dataSource->columnCount();
+}
+
+QVariant CSVTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+    return m_dataSource->cellData(index.row(), index.column());
+}
+
+QVariant CSVTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return m_dataSource->columnNameByIndex(section);
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+CSVDataSource::CSVDataSource()
+    : m_data(0), m_size(0), m_rowCount(0), m_curRow(-1), m_model(0)
+{}
+
+CSVDataSource::~CSVDataSource()
+{
+    delete m_model;
+}
+
+void CSVDataSource::clear()
+{
+    if (m_model) m_model->beginResetModel();
+    m_columns.clear();
+    m_columnIndex.clear();
+    m_rowCount = 0;
+    m_curRow = -1;
+    m_lastError.clear();
+    m_data = 0;
+    m_size = 0;
+    m_buffer.clear();
+    if (m_file.isOpen()) m_file.close();
+}
+
+void CSVDataSource::setCSVText(const QString &csvText, const QString &separator, bool firstRowIsHeader, bool inferTypes)
+{
+    clear();
+    m_buffer = csvText.toUtf8();
+    m_data = m_buffer.constData();
+    m_size = m_buffer.size();
+    parse(separator, firstRowIsHeader, inferTypes);
+}
+
+bool CSVDataSource::setCSVFile(const QString &fileName, const QString &separator, bool firstRowIsHeader, bool inferTypes)
+{
+    clear();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)){
+        m_lastError = QObject::tr("Can't open file \"%1\"").arg(fileName);
+        if (m_model) m_model->endResetModel();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size > 0){
+        uchar* mapped = m_file.map(0, m_size);
+        if (mapped){
+            m_data = reinterpret_cast<const char*>(mapped);
+        } else {
+            m_buffer = m_file.readAll();
+            m_data = m_buffer.constData();
+            m_size = m_buffer.size();
+            m_file.close();
+        }
+    }
+    parse(separator, firstRowIsHeader, inferTypes);
+    return true;
+}
+
+void CSVDataSource::parse(const QString &separator, bool firstRowIsHeader, bool inferTypes)
+{
+    QByteArray sep = (separator.compare("\\t") == 0) ? QByteArray("\t") : separator.toUtf8();
+    if (sep.isEmpty()) sep = ",";
+    const char* data = m_data;
+    const qint64 size = m_size;
+    const int sepSize = sep.size();
+    const char sepFirst = sep.at(0);
+
+    qint64 pos = 0;
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) pos = 3;
+
+    QVector<qint64> offsets;
+    QVector<int> lengths;
+    bool isHeader = firstRowIsHeader;
+
+    while (pos < size){
+        offsets.clear();
+        lengths.clear();
+        bool recordEnded = false;
+        while (!recordEnded){
+            qint64 start;
+            qint64 end;
+            bool escaped = false;
+            if (pos < size && data[pos] == '"'){
+                start = ++pos;
+                while (pos < size){
+                    if (data[pos] == '"'){
+                        if (pos + 1 < size && data[pos+1] == '"'){
+                            escaped = true;
+                            pos += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    ++pos;
+                }
+                end = pos;
+                if (pos < size) ++pos;
+                while (pos < size && data[pos] != '\n' && data[pos] != '\r' &&
+                       !(data[pos] == sepFirst && pos + sepSize <= size && std::memcmp(data + pos, sep.constData(), sepSize) == 0))
+                    ++pos;
+            } else {
+                start = pos;
+                while (pos < size && data[pos] != '\n' &&
+                       !(data[pos] == sepFirst && pos + sepSize <= size && std::memcmp(data + pos, sep.constData(), sepSize) == 0))
+                    ++pos;
+                end = pos;
+                if (end > start && data[end-1] == '\r') --end;
+            }
+            offsets.append(escaped ? -start-1 : start);
+            lengths.append(int(end - start));
+
+            if (pos < size && data[pos] == sepFirst && pos + sepSize <= size &&
+                std::memcmp(data + pos, sep.constData(), sepSize) == 0){
+                pos += sepSize;
+                if (pos >= size){
+                    offsets.append(pos);
+                    lengths.append(0);
+                    recordEnded = true;
+                }
+            } else {
+                if (pos < size && data[pos] == '\r') ++pos;
+                if (pos < size && data[pos] == '\n') ++pos;
+                recordEnded = true;
+            }
+        }
+        appendRecord(offsets, lengths, isHeader);
+        isHeader = false;
+    }
+
+    for (int i = 0; i < m_columns.count(); ++i){
+        Column& column = m_columns[i];
+        while (column.offsets.count() < m_rowCount){
+            column.offsets.append(0);
+            column.lengths.append(-1);
+        }
+        if (column.name.isEmpty()) column.name = QString::number(i+1);
+        if (inferTypes) inferColumnType(column);
+        QString key = column.name.toCaseFolded();
+        if (!m_columnIndex.contains(key)) m_columnIndex.insert(key, i);
+    }
+
+    if (m_model) m_model->endResetModel();
+}
+
+void CSVDataSource::appendRecord(const QVector<qint64> &offsets, const QVector<int> &lengths, bool isHeader)
+{
+    while (m_columns.count() < offsets.count()){
+        Column column;
+        column.offsets.fill(0, m_rowCount);
+        column.lengths.fill(-1, m_rowCount);
+        m_columns.append(column);
+    }
+    if (isHeader){
+        for (int i = 0; i < offsets.count(); ++i)
+            m_columns[i].name = decodeCell(offsets.at(i), lengths.at(i));
+        return;
+    }
+    for (int i = 0; i < m_columns.count(); ++i){
+        Column& column = m_columns[i];
+        if (i < offsets.count()){
+            column.offsets.append(offsets.at(i));
+            column.lengths.append(lengths.at(i));
+        } else {
+            column.offsets.append(0);
+            column.lengths.append(-1);
+        }
+    }
+    ++m_rowCount;
+}
+
+void CSVDataSource::inferColumnType(Column &column)
+{
+    bool allIntegers = true;
+    bool allNumbers = true;
+    int sampled = 0;
+    for (int row = 0; row < m_rowCount && sampled < TYPE_INFERENCE_SAMPLE && allNumbers; ++row){
+        int length = column.lengths.at(row);
+        qint64 offset = column.offsets.at(row);
+        if (length <= 0) continue;
+        if (offset < 0) { allNumbers = false; break; }
+        const char* text = m_data + offset;
+        if (allIntegers && !isIntegerText(text, length)) allIntegers = false;
+        if (!allIntegers && !isDoubleText(text, length)) allNumbers = false;
+        ++sampled;
+    }
+    if (sampled == 0 || !allNumbers)
+        column.type = StringColumn;
+    else
+        column.type = allIntegers ? IntegerColumn : DoubleColumn;
+}
+
+QString CSVDataSource::cellText(const Column &column, int row) const
+{
+    return decodeCell(column.offsets.at(row), column.lengths.at(row));
+}
+
+QString CSVDataSource::decodeCell(qint64 offset, int length) const
+{
+    if (offset < 0){
+        QString result = QString::fromUtf8(m_data - offset - 1, length);
+        return result.replace("\"\"", "\"");
+    }
+    return QString::fromUtf8(m_data + offset, length);
+}
+
+CSVDataSource::ColumnType CSVDataSource::columnType(int columnIndex) const
+{
+    if (columnIndex < 0 || columnIndex >= m_columns.count()) return StringColumn;
+    return m_columns.at(columnIndex).type;
+}
+
+QVariant CSVDataSource::cellData(int row, int column) const
+{
+    if (row < 0 || row >= m_rowCount || column < 0 || column >= m_columns.count())
+        return QVariant();
+    const Column& col = m_columns.at(column);
+    int length = col.lengths.at(row);
+    qint64 offset = col.offsets.at(row);
+    if (length < 0) return QVariant();
+    if (col.type == StringColumn || offset < 0) return cellText(col, row);
+    if (length == 0) return QVariant();
+    // types are inferred from a sample, cells past it may not be numbers
+    bool ok = false;
+    QByteArray text = QByteArray::fromRawData(m_data + offset, length);
+    if (col.type == IntegerColumn){
+        qlonglong value = text.toLongLong(&ok);
+        if (ok) return value;
+    } else {
+        double value = text.toDouble(&ok);
+        if (ok) return value;
+    }
+    return cellText(col, row);
+}
+
+int CSVDataSource::currentRow()
+{
+    if (eof()) return m_curRow-1;
+    if (bof()) return m_curRow+1;
+    return m_curRow;
+}
+
+bool CSVDataSource::next()
+{
+    if (m_curRow < m_rowCount){
+        if (bof()) m_curRow++;
+        m_curRow++;
+        return true;
+    } else return false;
+}
+
+bool CSVDataSource::hasNext()
+{
+    return m_curRow < m_rowCount-1;
+}
+
+bool CSVDataSource::prior()
+{
+    if (m_curRow > -1){
+        if (eof()) m_curRow--;
+        m_curRow--;
+        return true;
+    } else return false;
+}
+
+void CSVDataSource::first()
+{
+    m_curRow = 0;
+}
+
+void CSVDataSource::last()
+{
+    m_curRow = m_rowCount-1;
+}
+
+bool CSVDataSource::bof()
+{
+    return (m_curRow == -1) || (m_rowCount == 0);
+}
+
+bool CSVDataSource::eof()
+{
+    return (m_curRow == m_rowCount) || (m_rowCount == 0);
+}
+
+QVariant CSVDataSource::data(const QString &columnName)
+{
+    return cellData(currentRow(), columnIndexByName(columnName));
+}
+
+QVariant CSVDataSource::dataByRowIndex(const QString &columnName, int rowIndex)
+{
+    return cellData(rowIndex, columnIndexByName(columnName));
+}
+
+QVariant CSVDataSource::dataByKeyField(const QString &columnName, const QString &keyColumnName, QVariant keyData)
+{
+    int keyColumn = columnIndexByName(keyColumnName);
+    int column = columnIndexByName(columnName);
+    if (keyColumn == -1 || column == -1) return QVariant();
+    for (int i = 0; i < m_rowCount; ++i){
+        if (cellData(i, keyColumn) == keyData)
+            return cellData(i, column);
+    }
+    return QVariant();
+}
+
+int CSVDataSource::columnCount()
+{
+    return m_columns.count();
+}
+
+QString CSVDataSource::columnNameByIndex(int columnIndex)
+{
+    if (columnIndex < 0 || columnIndex >= m_columns.count()) return "";
+    return m_columns.at(columnIndex).name;
+}
+
+int CSVDataSource::columnIndexByName(QString name)
+{
+    return m_columnIndex.value(name.toCaseFolded(), -1);
+}
+
+bool CSVDataSource::isInvalid() const
+{
+    return !m_lastError.isEmpty();
+}
+
+QString CSVDataSource::lastError()
+{
+    return m_lastError;
+}
+
+QAbstractItemModel *CSVDataSource::model()
+{
+    if (!m_model) m_model = new CSVTableModel(this);
+    return m_model;
+}
+
+} // namespace LimeReport
@@ -0,0 +1,94 @@
+#ifndef LRCSVDATASOURCE_H
+#define LRCSVDATASOURCE_H
+
+#include <QObject>
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QVariant>
+#include "lrdatasourceintf.h"
+
+namespace LimeReport{
+
+class CSVDataSource;
+
+class CSVTableModel : public QAbstractTableModel{
+    Q_OBJECT
+    friend class CSVDataSource;
+public:
+    explicit CSVTableModel(CSVDataSource* dataSource);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+private:
+    CSVDataSource* m_dataSource;
+};
+
+// Read-only CSV datasource. The input is kept as one UTF-8 buffer (or a memory
+// mapped file) and every cell is stored as an offset/length pair per column;
+// cells are decoded and converted only when they are read.
+class CSVDataSource : public IDataSource{
+public:
+    enum ColumnType {StringColumn, IntegerColumn, DoubleColumn};
+    CSVDataSource();
+    ~CSVDataSource();
+    void setCSVText(const QString& csvText, const QString& separator, bool firstRowIsHeader, bool inferTypes);
+    bool setCSVFile(const QString& fileName, const QString& separator, bool firstRowIsHeader, bool inferTypes);
+    int  rowCount() const { return m_rowCount; }
+    ColumnType columnType(int columnIndex) const;
+    QVariant cellData(int row, int column) const;
+    // IDataSource interface
+    bool next();
+    bool hasNext();
+    bool prior();
+    void first();
+    void last();
+    bool bof();
+    bool eof();
+    QVariant data(const QString& columnName);
+    QVariant dataByRowIndex(const QString& columnName, int rowIndex);
+    QVariant dataByKeyField(const QString& columnName, const QString& keyColumnName, QVariant keyData);
+    int columnCount();
+    QString columnNameByIndex(int columnIndex);
+    int columnIndexByName(QString name);
+    bool isInvalid() const;
+    QString lastError();
+    QAbstractItemModel* model();
+private:
+    struct Column{
+        Column():type(StringColumn){}
+        QString name;
+        ColumnType type;
+        // negative offset marks a quoted cell containing escaped quotes,
+        // negative length marks a cell missing in a short row
+        QVector<qint64> offsets;
+        QVector<int> lengths;
+    };
+    void clear();
+    void parse(const QString& separator, bool firstRowIsHeader, bool inferTypes);
+    void appendRecord(const QVector<qint64>& offsets, const QVector<int>& lengths, bool isHeader);
+    void inferColumnType(Column& column);
+    QString cellText(const Column& column, int row) const;
+    QString decodeCell(qint64 offset, int length) const;
+    int currentRow();
+private:
+    QByteArray m_buffer;
+    QFile m_file;
+    const char* m_data;
+    qint64 m_size;
+    QVector<Column> m_columns;
+    // case folded column names, the first column wins on duplicates
+    QHash<QString, int> m_columnIndex;
+    int m_rowCount;
+    int m_curRow;
+    QString m_lastError;
+    CSVTableModel* m_model;
+};
+
+} // namespace LimeReport
+
+#endif // LRCSVDATASOURCE_H
@@ -34,7 +34,11 @@
 #include <QSqlError>
 #include <stdexcept>
 #include <QStringList>
+#include <QRegExp>
 #include "lrdatasourcemanager.h"
+#include "lrqueryprefetch.h"
+#include "lrqueryresultcache.h"
+#include "lrsorteddatasource.h"
 
 namespace LimeReport{
 
@@ -58,47 +62,75 @@ IDataSource * ModelHolder::dataSource(IDataSource::DatasourceMode mode)
 
 QueryHolder::QueryHolder(QString queryText, QString connectionName, DataSourceManager *dataManager)
     : m_queryText(queryText), m_connectionName(connectionName),
-      m_mode(IDataSource::RENDER_MODE), m_dataManager(dataManager), m_prepared(true)
+      m_mode(IDataSource::RENDER_MODE), m_dataManager(dataManager), m_prepared(true),
+      m_paramsExtracted(false), m_query(0)
 {
     extractParams();
 }
 
-QueryHolder::~QueryHolder(){}
+QueryHolder::~QueryHolder()
+{
+    releasePreparedQuery();
+}
 
 bool QueryHolder::runQuery(IDataSource::DatasourceMode mode)
 {
+    RenderProfileScope profileScope(m_dataManager ? m_dataManager->renderProfiler() : 0,
+                                    RenderProfiler::DataSource, "sql ", m_connectionName, "");
     m_mode = mode;
 
     QSqlDatabase db = QSqlDatabase::database(m_connectionName);
-    QSqlQuery query(db);
 
     if (!db.isValid()) {
         setLastError(QObject::tr("Invalid connection! %1").arg(m_connectionName));
         return false;
     }
 
-    extractParams();
-    if (!m_prepared) return false;
-
-    query.prepare(m_preparedSQL);
-    fillParams(&query);
-    query.exec();
+    if (!extractParamsIfNeeded()) return false;
 
-    QSqlQueryModel *model = new QSqlQueryModel;
-    model->setQuery(query);
+    QMap<QString, QVariant> params = paramValues();
+    QueryResultCache* cache = dataManager()->queryResultCache();
+    QString cacheKey;
+    if (cache->isEnabled()){
+        cacheKey = QueryResultCache::key(m_connectionName, m_preparedSQL, params);
+        QueryResult cached;
+        if (cache->find(cacheKey, cached)){
+            setResult(cached);
+            return true;
+        }
+    }
 
-    while (model->canFetchMore())
-        model->fetchMore();
+    QSqlQuery* query = preparedQuery(db);
+    bindParams(query, params);
+
+    // the statement is kept prepared for the next run, so the rows are copied
+    // out of it instead of handing it to a model that would read it lazily
+    QueryResult result;
+    if (query->exec()){
+        QSqlRecord header = query->record();
+        for (int i = 0; i < header.count(); ++i)
+            result.fieldNames.append(header.fieldName(i));
+        while (query->next()){
+            QVariantList values;
+            values.reserve(header.count());
+            for (int i = 0; i < header.count(); ++i)
+                values.append(query->value(i));
+            result.rows.append(values);
+        }
+    }
 
-    if (model->lastError().isValid()){
+    if (query->lastError().isValid()){
         if (m_dataSource)
            m_dataSource.clear();
-        setLastError(model->lastError().text());
-        delete model;
+        setLastError(query->lastError().text());
+        releasePreparedQuery();
         return false;
-    } else { setLastError("");}
+    }
+
+    if (!cacheKey.isEmpty())
+        cache->insert(cacheKey, m_connectionName, result);
 
-    setDatasource(IDataSource::Ptr(new ModelToDataSource(model,true)));
+    setResult(result);
     return true;
 }
 
@@ -110,9 +142,11 @@ QString QueryHolder::connectionName()
 void QueryHolder::setConnectionName(QString connectionName)
 {
     m_connectionName=connectionName;
+    resetParams();
 }
 
 void QueryHolder::invalidate(IDataSource::DatasourceMode mode, bool dbWillBeClosed){
+    resetParams();
     QSqlDatabase db = QSqlDatabase::database(m_connectionName);
     if (!db.isValid() || dbWillBeClosed){
         setLastError(QObject::tr("Invalid connection! %1").arg(m_connectionName));
@@ -133,8 +167,9 @@ void QueryHolder::setDatasource(IDataSource::Ptr value){
     m_dataSource=value;
 }
 
-void QueryHolder::fillParams(QSqlQuery *query)
+QMap<QString, QVariant> QueryHolder::paramValues()
 {
+    QMap<QString, QVariant> result;
     foreach(QString param,m_aliasesToParam.keys()){
         QVariant value;
         if (param.contains(".")){
@@ -143,9 +178,22 @@ void QueryHolder::fillParams(QSqlQuery *query)
         } else {
             value = dataManager()->variable(m_aliasesToParam.value(param));
         }
-        if (value.isValid() || m_mode == IDataSource::DESIGN_MODE)
-            query->bindValue(':'+param,value);
+        result.insert(':'+param, value);
     }
+    return result;
+}
+
+void QueryHolder::bindParams(QSqlQuery *query, const QMap<QString, QVariant> &params)
+{
+    // the statement is reused, so an unset param must not keep the previous value
+    QMap<QString, QVariant>::const_iterator it = params.constBegin();
+    for (; it != params.constEnd(); ++it)
+        query->bindValue(it.key(), it.value());
+}
+
+void QueryHolder::fillParams(QSqlQuery *query)
+{
+    bindParams(query, paramValues());
 }
 
 void QueryHolder::extractParams()
@@ -154,6 +202,41 @@ void QueryHolder::extractParams()
     m_prepared = true;
 }
 
+bool QueryHolder::extractParamsIfNeeded()
+{
+    if (!m_paramsExtracted){
+        m_aliasesToParam.clear();
+        extractParams();
+        m_paramsExtracted = m_prepared;
+    }
+    return m_prepared;
+}
+
+void QueryHolder::resetParams()
+{
+    m_paramsExtracted = false;
+    releasePreparedQuery();
+}
+
+QSqlQuery* QueryHolder::preparedQuery(QSqlDatabase db)
+{
+    if (!m_query || m_querySQL != m_preparedSQL){
+        releasePreparedQuery();
+        m_query = new QSqlQuery(db);
+        m_query->setForwardOnly(true);
+        m_query->prepare(m_preparedSQL);
+        m_querySQL = m_preparedSQL;
+    }
+    return m_query;
+}
+
+void QueryHolder::releasePreparedQuery()
+{
+    delete m_query;
+    m_query = 0;
+    m_querySQL.clear();
+}
+
 QString QueryHolder::replaceVariables(QString query)
 {
     return dataManager()->replaceVariables(query, m_aliasesToParam);
@@ -168,11 +251,73 @@ void QueryHolder::setQueryText(QString queryText)
 {
     m_queryText=queryText;
     m_prepared = false;
+    resetParams();
+}
+
+bool QueryHolder::needsRun(IDataSource::DatasourceMode mode) const
+{
+    return (m_mode != mode && m_mode == IDataSource::DESIGN_MODE) || m_dataSource==0;
+}
+
+void QueryHolder::discardResult()
+{
+    resetParams();
+    m_dataSource.clear();
+}
+
+QueryPrefetchTask* QueryHolder::createPrefetchTask()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    if (!db.isValid() || !db.isOpen()) return 0;
+    // a clone of an in-memory database would be a different, empty database
+    if (db.driverName().startsWith("QSQLITE") &&
+        (db.databaseName().isEmpty() || db.databaseName() == ":memory:" ||
+         db.connectOptions().contains("QSQLITE_OPEN_URI")))
+        return 0;
+    if (!extractParamsIfNeeded()) return 0;
+
+    QueryPrefetchTask* task = new QueryPrefetchTask(m_connectionName, m_preparedSQL);
+    foreach(QString param, m_aliasesToParam.keys()){
+        if (param.contains(".")){
+            delete task;
+            return 0;
+        }
+        QVariant value = dataManager()->variable(m_aliasesToParam.value(param));
+        task->bindValue(':'+param, value);
+    }
+
+    QueryResultCache* cache = dataManager()->queryResultCache();
+    if (cache->isEnabled()){
+        QueryResult cached;
+        if (cache->find(QueryResultCache::key(m_connectionName, m_preparedSQL, task->boundValues()), cached)){
+            delete task;
+            m_mode = IDataSource::RENDER_MODE;
+            setResult(cached);
+            return 0;
+        }
+    }
+    return task;
+}
+
+void QueryHolder::setPrefetchedResult(const QueryPrefetchTask &task)
+{
+    m_mode = IDataSource::RENDER_MODE;
+    setResult(task.result());
+    QueryResultCache* cache = dataManager()->queryResultCache();
+    if (cache->isEnabled())
+        cache->insert(QueryResultCache::key(m_connectionName, m_preparedSQL, task.boundValues()),
+                      m_connectionName, task.result());
+}
+
+void QueryHolder::setResult(const QueryResult &result)
+{
+    setLastError("");
+    setDatasource(IDataSource::Ptr(new ModelToDataSource(new QueryResultModel(result), true)));
 }
 
 IDataSource* QueryHolder::dataSource(IDataSource::DatasourceMode mode)
 {
-    if ((m_mode != mode && m_mode == IDataSource::DESIGN_MODE) || m_dataSource==0) {
+    if (needsRun(mode)) {
         m_mode = mode;
         runQuery(mode);
     }
@@ -402,7 +547,8 @@ QueryDesc::QueryDesc(QString queryName, QString queryText, QString connection)
 {}
 
 SubQueryHolder::SubQueryHolder(QString queryText, QString connectionName, QString masterDatasource, DataSourceManager* dataManager)
-    : QueryHolder(queryText, connectionName, dataManager), m_masterDatasource(masterDatasource)/*, m_invalid(false)*/
+    : QueryHolder(queryText, connectionName, dataManager), m_masterDatasource(masterDatasource)/*, m_invalid(false)*/,
+      m_batchSize(0)
 {
     extractParams();
 }
@@ -411,6 +557,7 @@ void SubQueryHolder::setMasterDatasource(const QString &value)
 {
     if (dataManager()->dataSource(value)){
         m_masterDatasource = value;
+        resetParams();
     }
 }
 
@@ -438,8 +585,250 @@ QString SubQueryHolder::replaceFields(QString query)
     return dataManager()->replaceFields(query, m_aliasesToParam);
 }
 
+bool SubQueryHolder::runQuery(IDataSource::DatasourceMode mode)
+{
+    if (mode == IDataSource::RENDER_MODE && isBatched() && runBatchedQuery()){
+        setMode(mode);
+        return !isInvalid();
+    }
+    return QueryHolder::runQuery(mode);
+}
+
+void SubQueryHolder::invalidate(IDataSource::DatasourceMode mode, bool dbWillBeClosed)
+{
+    clearBatch();
+    QueryHolder::invalidate(mode, dbWillBeClosed);
+}
+
+void SubQueryHolder::update()
+{
+    clearBatch();
+    QueryHolder::update();
+}
+
+void SubQueryHolder::setBatchKeyField(const QString &value)
+{
+    if (m_batchKeyField != value){
+        m_batchKeyField = value;
+        clearBatch();
+    }
+}
+
+void SubQueryHolder::setBatchSize(int value)
+{
+    if (value < 0) value = ALL_MASTER_ROWS;
+    if (m_batchSize != value){
+        m_batchSize = value;
+        clearBatch();
+    }
+}
+
+void SubQueryHolder::clearBatch()
+{
+    m_batchModel.clear();
+    m_batchKeys.clear();
+    m_batchRows.clear();
+    m_batchKeysByText.clear();
+}
+
+int SubQueryHolder::batchKeyIndex(const QVariant &value) const
+{
+    foreach(int index, m_batchKeysByText.value(value.toString())){
+        if (m_batchKeys.at(index) == value) return index;
+    }
+    return -1;
+}
+
+int SubQueryHolder::appendBatchKey(const QVariant &value)
+{
+    m_batchKeys.append(value);
+    m_batchRows.append(QVector<int>());
+    m_batchKeysByText[value.toString()].append(m_batchKeys.count() - 1);
+    return m_batchKeys.count() - 1;
+}
+
+// the window is read by row index from the current master row on,
+// so only masters that know their position can be batched
+static bool masterPosition(IDataSource* master, int& currentRow, int& rowCount)
+{
+    ModelToDataSource* modelSource = dynamic_cast<ModelToDataSource*>(master);
+    if (modelSource){
+        currentRow = modelSource->currentRow();
+        rowCount = modelSource->model()->rowCount();
+        return true;
+    }
+    SortedDataSource* sortedSource = dynamic_cast<SortedDataSource*>(master);
+    if (sortedSource){
+        currentRow = sortedSource->currentRow();
+        rowCount = sortedSource->rowCount();
+        return true;
+    }
+    return false;
+}
+
+bool SubQueryHolder::batchingError(const QString &reason)
+{
+    setLastError(QObject::tr("Batch mode of subquery on \"%1\": %2").arg(m_masterDatasource).arg(reason));
+    setDatasource(IDataSource::Ptr());
+    clearBatch();
+    return true;
+}
+
+bool SubQueryHolder::runBatchedQuery()
+{
+    IDataSource* master = dataManager()->dataSource(m_masterDatasource);
+    // nothing to batch, the master row values are read as usual
+    if (!master || master->isInvalid() || master->eof()) return false;
+
+    int masterRow = 0;
+    int masterRowCount = 0;
+    if (!masterPosition(master, masterRow, masterRowCount))
+        return batchingError(QObject::tr("master datasource must be a query or a model"));
+
+    if (!extractParamsIfNeeded()) return false;
+
+    QString masterField;
+    foreach(QString param, m_aliasesToParam.keys()){
+        QString source = m_aliasesToParam.value(param);
+        if (source.contains('.') && dataManager()->extractDataSource(source).compare(m_masterDatasource, Qt::CaseInsensitive) == 0){
+            QString field = dataManager()->extractFieldName(source);
+            if (!masterField.isEmpty() && masterField.compare(field, Qt::CaseInsensitive) != 0)
+                return batchingError(QObject::tr("only one master field can be batched, found \"%1\" and \"%2\"").arg(masterField).arg(field));
+            masterField = field;
+        }
+    }
+    if (masterField.isEmpty())
+        return batchingError(QObject::tr("query does not reference a master field"));
+
+    QVariant key = master->data(masterField);
+    int keyIndex = batchKeyIndex(key);
+    // NULL never matches in IN, so such a master row simply has no details;
+    // the window is still fetched once to know the detail columns
+    if (keyIndex == -1 && (!key.isNull() || !m_batchModel)){
+        if (!fetchBatch(master, masterField, masterRow, masterRowCount)) return true;
+        keyIndex = batchKeyIndex(key);
+    }
+
+    setDatasource(IDataSource::Ptr(new ModelToDataSource(
+        new SubQueryBatchSliceModel(m_batchModel, keyIndex != -1 ? m_batchRows.at(keyIndex) : QVector<int>()), true)
+    ));
+    return true;
+}
+
+bool SubQueryHolder::fetchBatch(IDataSource *master, const QString &masterField, int startRow, int masterRowCount)
+{
+    clearBatch();
+
+    QSqlDatabase db = QSqlDatabase::database(connectionName());
+    if (!db.isValid()) {
+        setLastError(QObject::tr("Invalid connection! %1").arg(connectionName()));
+        setDatasource(IDataSource::Ptr());
+        return false;
+    }
+
+    // drivers limit the number of bound values, so a window never has more
+    // than SUBQUERY_BATCH_MAX_KEYS keys; the next one is fetched on demand
+    int endRow = (m_batchSize == ALL_MASTER_ROWS) ? masterRowCount
+                                                  : qMin(startRow + m_batchSize, masterRowCount);
+    QList<QVariant> keyValues;
+    for (int i = startRow; i < endRow && keyValues.count() < Const::SUBQUERY_BATCH_MAX_KEYS; ++i){
+        QVariant value = master->dataByRowIndex(masterField, i);
+        if (!value.isNull() && batchKeyIndex(value) == -1){
+            appendBatchKey(value);
+            keyValues.append(value);
+        }
+    }
+
+    QStringList keyParams;
+    for (int i = 0; i < keyValues.count(); ++i)
+        keyParams.append(QString(":lr_batch_key_%1").arg(i));
+    // a window of NULL keys only still needs a valid IN list
+    if (keyParams.isEmpty())
+        keyParams.append(":lr_batch_key_0");
+
+    // the master field placeholders become the key list and are not bound
+    QMap<QString, QVariant> params = paramValues();
+    QString sql = m_preparedSQL;
+    foreach(QString param, m_aliasesToParam.keys()){
+        QString source = m_aliasesToParam.value(param);
+        if (source.contains('.') && dataManager()->extractDataSource(source).compare(m_masterDatasource, Qt::CaseInsensitive) == 0){
+            sql.replace(QRegExp(":"+QRegExp::escape(extractField(param))+"\\b"), keyParams.join(", "));
+            params.remove(":"+extractField(param));
+        }
+    }
+
+    QSqlQuery query(db);
+    query.prepare(sql);
+    bindParams(&query, params);
+    for (int i = 0; i < keyParams.count(); ++i)
+        query.bindValue(keyParams.at(i), i < keyValues.count() ? keyValues.at(i) : QVariant());
+    query.exec();
+
+    QSqlQueryModel* model = new QSqlQueryModel;
+    model->setQuery(query);
+    while (model->canFetchMore())
+        model->fetchMore();
+
+    if (model->lastError().isValid()){
+        setLastError(model->lastError().text());
+        setDatasource(IDataSource::Ptr());
+        delete model;
+        clearBatch();
+        return false;
+    }
+
+    int keyColumn = -1;
+    for (int i = 0; i < model->columnCount(); ++i){
+        if (model->headerData(i, Qt::Horizontal).toString().compare(m_batchKeyField, Qt::CaseInsensitive) == 0){
+            keyColumn = i;
+            break;
+        }
+    }
+    if (keyColumn == -1){
+        setLastError(QObject::tr("Batch key field \"%1\" not found!").arg(m_batchKeyField));
+        setDatasource(IDataSource::Ptr());
+        delete model;
+        clearBatch();
+        return false;
+    }
+
+    for (int i = 0; i < model->rowCount(); ++i){
+        int keyIndex = batchKeyIndex(model->data(model->index(i, keyColumn)));
+        if (keyIndex != -1)
+            m_batchRows[keyIndex].append(i);
+    }
+    m_batchModel = QSharedPointer<QAbstractItemModel>(model);
+    setLastError("");
+    return true;
+}
+
+int SubQueryBatchSliceModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_rows.count();
+}
+
+int SubQueryBatchSliceModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_source->columnCount();
+}
+
+QVariant SubQueryBatchSliceModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.count()) return QVariant();
+    return m_source->data(m_source->index(m_rows.at(index.row()), index.column()), role);
+}
+
+QVariant SubQueryBatchSliceModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal)
+        return m_source->headerData(section, orientation, role);
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
 SubQueryDesc::SubQueryDesc(QString queryName, QString queryText, QString connection, QString masterDatasourceName)
-    :QueryDesc(queryName,queryText,connection), m_masterDatasourceName(masterDatasourceName)
+    :QueryDesc(queryName,queryText,connection), m_masterDatasourceName(masterDatasourceName), m_batchSize(0)
 {
 }
 
@@ -612,6 +1001,15 @@ QVariant MasterDetailProxyModel::masterData(QString fieldName) const
 }
 
 bool CallbackDatasource::next(){
+    if (isBlockMode()){
+        if (m_eof) return false;
+        if (!blockRowExists(m_currentRow+1)){
+            m_eof = true;
+            return false;
+        }
+        m_currentRow++;
+        return true;
+    }
     if (!m_eof){
         bool nextRowExists = checkNextRecord(m_currentRow);
         if (m_currentRow>-1){
@@ -645,7 +1043,22 @@ bool CallbackDatasource::next(){
     } else return false;
 }
 
+bool CallbackDatasource::hasNext()
+{
+    if (m_eof) return false;
+    if (isBlockMode()) return blockRowExists(m_currentRow+1);
+    return checkNextRecord(m_currentRow);
+}
+
 bool CallbackDatasource::prior(){
+     if (isBlockMode()){
+         if (m_currentRow > 0){
+             m_currentRow--;
+             m_eof = false;
+             return true;
+         }
+         return false;
+     }
      if (m_currentRow !=-1) {
         if (!m_getDataFromCache && !m_valuesCache.isEmpty()){
             m_getDataFromCache = true;
@@ -663,6 +1076,11 @@ bool CallbackDatasource::prior(){
 void CallbackDatasource::first(){
     m_currentRow = 0;
     m_getDataFromCache = false;
+    if (isBlockMode()){
+        clearBlock();
+        m_eof = !blockRowExists(0);
+        return;
+    }
     m_eof=checkIfEmpty();
     bool result=false;
 
@@ -688,9 +1106,62 @@ QVariant CallbackDatasource::callbackData(const QString& columnName, int row)
     return result;
 }
 
+bool CallbackDatasource::isBlockMode()
+{
+    return m_blockSize > 0 &&
+           receivers(SIGNAL(getCallbackDataBlock(LimeReport::CallbackInfo,QVector<QVariantList>&))) > 0;
+}
+
+void CallbackDatasource::clearBlock()
+{
+    m_block.clear();
+    m_blockColumns.clear();
+    m_blockStart = 0;
+    m_blockAtEnd = false;
+}
+
+void CallbackDatasource::fetchBlock(int row)
+{
+    if (m_blockColumns.isEmpty()){
+        columnCount();
+        for (int i = 0; i < m_headers.size(); ++i)
+            m_blockColumns.insert(m_headers.at(i), i);
+    }
+    CallbackInfo info;
+    info.dataType = CallbackInfo::RowBlock;
+    info.index = row;
+    info.blockSize = m_blockSize;
+    info.columnNames = m_headers.toList();
+    m_block.clear();
+    emit getCallbackDataBlock(info, m_block);
+    m_blockStart = row;
+    m_blockAtEnd = m_block.size() < m_blockSize;
+}
+
+bool CallbackDatasource::blockRowExists(int row)
+{
+    if (row < 0) return false;
+    int blockEnd = m_blockStart + m_block.size();
+    if (row >= m_blockStart && row < blockEnd) return true;
+    if (m_blockAtEnd && row >= blockEnd && row >= m_blockStart) return false;
+    fetchBlock(row);
+    return !m_block.isEmpty();
+}
+
+QVariant CallbackDatasource::blockData(const QString &columnName, int row)
+{
+    if (!blockRowExists(row)) return QVariant();
+    int column = m_blockColumns.value(columnName, -1);
+    if (column == -1) return callbackData(columnName, row);
+    const QVariantList& values = m_block.at(row - m_blockStart);
+    return column < values.size() ? values.at(column) : QVariant();
+}
+
 QVariant CallbackDatasource::data(const QString& columnName)
 {
     QVariant result;
+    if (isBlockMode())
+        return bof() ? result : blockData(columnName, m_currentRow);
     if (!bof())
     {
         if (!m_getDataFromCache){
@@ -704,6 +1175,7 @@ QVariant CallbackDatasource::data(const QString& columnName)
 
 QVariant CallbackDatasource::dataByRowIndex(const QString &columnName, int rowIndex)
 {
+    if (isBlockMode()) return blockData(columnName, rowIndex);
     int backupCurrentRow = m_currentRow;
     QVariant result = QVariant();
     first();
@@ -722,6 +1194,22 @@ QVariant CallbackDatasource::dataByKeyField(const QString& columnName, const QSt
     int backupCurrentRow = m_currentRow;
     QVariant result = QVariant();
 
+    if (isBlockMode()){
+        for (int row = m_lastKeyRow; blockRowExists(row); ++row){
+            if (blockData(keyColumnName, row) == keyData){
+                m_lastKeyRow = row;
+                return blockData(columnName, row);
+            }
+        }
+        for (int row = 0; row < m_lastKeyRow && blockRowExists(row); ++row){
+            if (blockData(keyColumnName, row) == keyData){
+                m_lastKeyRow = row;
+                return blockData(columnName, row);
+            }
+        }
+        return result;
+    }
+
     m_currentRow = m_lastKeyRow;
     if (next()){
         for (int i = 0; i < 10; ++i){
@@ -885,34 +1373,32 @@ void CSVDesc::setFirstRowIsHeader(bool firstRowIsHeader)
     m_firstRowIsHeader = firstRowIsHeader;
 }
 
-void CSVHolder::updateModel()
+QString CSVDesc::fileName() const
 {
-    m_model.clear();
-    QString sep = (separator().compare("\\t") == 0) ? "\t" : separator();
-    bool firstRow = true;
-    QList<QStandardItem*> columns;
-    QStringList headers;
-    foreach(QString line, m_csvText.split('\n')){
-        columns.clear();
-        foreach(QString item, line.split(sep)){
-            columns.append(new QStandardItem(item));
-            if (firstRow && m_firstRowIsHeader) headers.append(item);
-        }
+    return m_fileName;
+}
 
-        if (firstRow){
-            if (!headers.isEmpty()){
-                m_model.setHorizontalHeaderLabels(headers);
-                firstRow = false;
-            } else {
-                m_model.appendRow(columns);
-            }
-        } else {
-            m_model.appendRow(columns);
-        }
+void CSVDesc::setFileName(const QString &fileName)
+{
+    m_fileName = fileName;
+}
 
-    }
+bool CSVDesc::inferTypes() const
+{
+    return m_inferTypes;
+}
 
+void CSVDesc::setInferTypes(bool inferTypes)
+{
+    m_inferTypes = inferTypes;
+}
 
+void CSVHolder::updateModel()
+{
+    if (!m_fileName.isEmpty())
+        m_dataSource->setCSVFile(m_fileName, m_separator, m_firstRowIsHeader, m_inferTypes);
+    else
+        m_dataSource->setCSVText(m_csvText, m_separator, m_firstRowIsHeader, m_inferTypes);
 }
 
 bool CSVHolder::firsRowIsHeader() const
@@ -925,13 +1411,37 @@ void CSVHolder::setFirsRowIsHeader(bool firstRowIsHeader)
     m_firstRowIsHeader = firstRowIsHeader;
 }
 
+QString CSVHolder::fileName() const
+{
+    return m_fileName;
+}
+
+void CSVHolder::setFileName(const QString &fileName)
+{
+    m_fileName = fileName;
+    updateModel();
+}
+
+bool CSVHolder::inferTypes() const
+{
+    return m_inferTypes;
+}
+
+void CSVHolder::setInferTypes(bool inferTypes)
+{
+    m_inferTypes = inferTypes;
+    updateModel();
+}
+
 CSVHolder::CSVHolder(const CSVDesc &desc, DataSourceManager *dataManager)
     : m_csvText(desc.csvText()),
       m_separator(desc.separator()),
       m_dataManager(dataManager),
-      m_firstRowIsHeader(desc.firstRowIsHeader())
+      m_firstRowIsHeader(desc.firstRowIsHeader()),
+      m_fileName(desc.fileName()),
+      m_inferTypes(desc.inferTypes())
 {
-    m_dataSource = IDataSource::Ptr(new ModelToDataSource(&m_model, false));
+    m_dataSource = QSharedPointer<CSVDataSource>(new CSVDataSource());
     updateModel();
 }
 
@@ -39,13 +39,18 @@
 #include <QSharedPointer>
 #include <QSortFilterProxyModel>
 #include <QVariant>
+#include <QSet>
 #include "lrcollection.h"
 #include "lrcallbackdatasourceintf.h"
 #include "lrdatasourceintf.h"
+#include "lrcsvdatasource.h"
 
 namespace LimeReport{
 
 class DataSourceManager;
+class QueryPrefetchTask;
+struct QueryResult;
+class ModelToDataSource;
 
 class ModelHolder: public QObject, public IDataSourceHolder{
     Q_OBJECT
@@ -138,10 +143,13 @@ class CSVDesc: public QObject{
     Q_PROPERTY(QString csvText READ csvText WRITE setCsvText)
     Q_PROPERTY(QString separator READ separator WRITE setSeparator)
     Q_PROPERTY(bool firstRowIsHeader READ firstRowIsHeader WRITE setFirstRowIsHeader)
+    Q_PROPERTY(QString fileName READ fileName WRITE setFileName)
+    Q_PROPERTY(bool inferTypes READ inferTypes WRITE setInferTypes)
 public:
     CSVDesc(const QString name, const QString csvText, QString separator, bool firstRowIsHeader)
-        : m_csvName(name), m_csvText(csvText), m_separator(separator), m_firstRowIsHeader(firstRowIsHeader){}
-    explicit CSVDesc(QObject* parent = 0):QObject(parent) {}
+        : m_csvName(name), m_csvText(csvText), m_separator(separator), m_firstRowIsHeader(firstRowIsHeader),
+          m_inferTypes(false){}
+    explicit CSVDesc(QObject* parent = 0):QObject(parent), m_firstRowIsHeader(false), m_inferTypes(false) {}
     QString name() const;
     void setName(const QString &name);
     QString csvText() const;
@@ -150,6 +158,10 @@ public:
     void setSeparator(const QString &separator);
     bool firstRowIsHeader() const;
     void setFirstRowIsHeader(bool firstRowIsHeader);
+    QString fileName() const;
+    void setFileName(const QString &fileName);
+    bool inferTypes() const;
+    void setInferTypes(bool inferTypes);
 signals:
     void cvsTextChanged(const QString& cvsName, const QString& cvsText);
 private:
@@ -157,6 +169,8 @@ private:
     QString m_csvText;
     QString m_separator;
     bool m_firstRowIsHeader;
+    QString m_fileName;
+    bool m_inferTypes;
 };
 
 class CSVHolder: public IDataSourceHolder{
@@ -168,11 +182,15 @@ public:
     void setSeparator(const QString &separator);
     bool firsRowIsHeader() const;
     void setFirsRowIsHeader(bool firstRowIsHeader);
+    QString fileName() const;
+    void setFileName(const QString &fileName);
+    bool inferTypes() const;
+    void setInferTypes(bool inferTypes);
     // IDataSourceHolder interface
 public:
     IDataSource *dataSource(IDataSource::DatasourceMode mode = IDataSource::RENDER_MODE);
-    QString lastError() const {return "";}
-    bool isInvalid() const {return false;}
+    QString lastError() const {return m_dataSource->isInvalid() ? m_dataSource->lastError() : "";}
+    bool isInvalid() const {return m_dataSource->isInvalid();}
     bool isOwned() const {return true;}
     bool isEditable() const {return true;}
     bool isRemovable() const {return true;}
@@ -183,11 +201,12 @@ private:
     void updateModel();
 private:
     QString m_csvText;
-    QStandardItemModel m_model;
     QString m_separator;
-    IDataSource::Ptr m_dataSource;
+    QSharedPointer<CSVDataSource> m_dataSource;
     DataSourceManager* m_dataManager;
     bool m_firstRowIsHeader;
+    QString m_fileName;
+    bool m_inferTypes;
 };
 
 class QueryDesc : public QObject{
@@ -233,11 +252,23 @@ public:
     void update();
     void clearErrors(){setLastError("");}
     DataSourceManager* dataManager() const {return m_dataManager;}
+    void releasePreparedQuery();
+    bool needsRun(IDataSource::DatasourceMode mode) const;
+    void discardResult();
+    QueryPrefetchTask* createPrefetchTask();
+    void setPrefetchedResult(const QueryPrefetchTask& task);
 protected:
     void setDatasource(IDataSource::Ptr value);
     void setPrepared(bool prepared){ m_prepared = prepared;}
+    void setMode(IDataSource::DatasourceMode mode){ m_mode = mode;}
+    void setResult(const QueryResult& result);
     virtual void fillParams(QSqlQuery* query);
+    QMap<QString, QVariant> paramValues();
+    void bindParams(QSqlQuery* query, const QMap<QString, QVariant>& params);
     virtual void extractParams();
+    bool extractParamsIfNeeded();
+    void resetParams();
+    QSqlQuery* preparedQuery(QSqlDatabase db);
     QString replaceVariables(QString query);
     QMap<QString,QString> m_aliasesToParam;
     QString m_preparedSQL;
@@ -249,18 +280,29 @@ private:
     IDataSource::DatasourceMode m_mode;
     DataSourceManager* m_dataManager;
     bool m_prepared;
+    bool m_paramsExtracted;
+    QSqlQuery* m_query;
+    QString m_querySQL;
 };
 
 class SubQueryDesc : public QueryDesc{
     Q_OBJECT
     Q_PROPERTY(QString master READ master WRITE setMaster)
+    Q_PROPERTY(QString batchKeyField READ batchKeyField WRITE setBatchKeyField)
+    Q_PROPERTY(int batchSize READ batchSize WRITE setBatchSize)
 public:
     SubQueryDesc(QString queryName, QString queryText, QString connection, QString master);
-    explicit SubQueryDesc(QObject* parent=0):QueryDesc(parent){}
+    explicit SubQueryDesc(QObject* parent=0):QueryDesc(parent), m_batchSize(0){}
     void setMaster(QString value){m_masterDatasourceName=value;}
     QString master(){return m_masterDatasourceName;}
+    void setBatchKeyField(const QString& value){m_batchKeyField=value;}
+    QString batchKeyField() const {return m_batchKeyField;}
+    void setBatchSize(int value){m_batchSize=value;}
+    int batchSize() const {return m_batchSize;}
 private:
     QString m_masterDatasourceName;
+    QString m_batchKeyField;
+    int m_batchSize;
 };
 
 class SubQueryHolder:public QueryHolder{
@@ -270,13 +312,58 @@ public:
     void setMasterDatasource(const QString& value);
     //void invalidate(){m_invalid = true;}
     bool isInvalid() const{ return QueryHolder::isInvalid(); /*|| m_invalid;*/}
+    bool runQuery(IDataSource::DatasourceMode mode = IDataSource::RENDER_MODE);
+    void invalidate(IDataSource::DatasourceMode mode, bool dbWillBeClosed = false);
+    void update();
+    // Batched mode: detail rows for a window of batchSize master rows are fetched
+    // by one query and partitioned by batchKeyField; batchSize 0 turns it off and
+    // ALL_MASTER_ROWS (any negative value) takes the rest of the master. One query
+    // binds at most Const::SUBQUERY_BATCH_MAX_KEYS distinct keys, so a larger
+    // window is fetched in several queries.
+    // The master field placeholder is expanded to a list, so the query should
+    // compare it with IN, e.g. "where order_id in ($D{orders.id})". The master
+    // must be a query or a model, sorted or not, and exactly one of its fields may
+    // be referenced, otherwise lastError() tells why and no rows are returned.
+    enum {ALL_MASTER_ROWS = -1};
+    QString batchKeyField() const {return m_batchKeyField;}
+    void setBatchKeyField(const QString& value);
+    int batchSize() const {return m_batchSize;}
+    void setBatchSize(int value);
+    bool isBatched() const {return m_batchSize != 0 && !m_batchKeyField.isEmpty();}
 protected:
     void extractParams();
     QString extractField(QString source);
     QString replaceFields(QString query);
+    bool runBatchedQuery();
+    bool batchingError(const QString& reason);
+    bool fetchBatch(IDataSource* master, const QString& masterField, int startRow, int masterRowCount);
+    void clearBatch();
+    int  batchKeyIndex(const QVariant& value) const;
+    int  appendBatchKey(const QVariant& value);
 private:
     QString m_masterDatasource;
     //bool m_invalid;
+    QString m_batchKeyField;
+    int m_batchSize;
+    QSharedPointer<QAbstractItemModel> m_batchModel;
+    // keys are compared as QVariant, the hash by text only narrows the search
+    QVector<QVariant> m_batchKeys;
+    QVector< QVector<int> > m_batchRows;
+    QHash<QString, QVector<int> > m_batchKeysByText;
+};
+
+class SubQueryBatchSliceModel : public QAbstractTableModel{
+    Q_OBJECT
+public:
+    SubQueryBatchSliceModel(QSharedPointer<QAbstractItemModel> source, const QVector<int>& rows)
+        : m_source(source), m_rows(rows){}
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+private:
+    QSharedPointer<QAbstractItemModel> m_source;
+    QVector<int> m_rows;
 };
 
 struct FieldsCorrelation{
@@ -411,12 +498,15 @@ class CallbackDatasource :public ICallbackDatasource, public IDataSource {
     Q_OBJECT
 public:
     CallbackDatasource():  m_currentRow(-1), m_eof(false), m_columnCount(-1),
-                           m_rowCount(-1), m_getDataFromCache(false), m_lastKeyRow(0){}
+                           m_rowCount(-1), m_getDataFromCache(false), m_lastKeyRow(0),
+                           m_blockSize(0), m_blockStart(0), m_blockAtEnd(false){}
     bool next();
-    bool hasNext(){ if (!m_eof) return checkNextRecord(m_currentRow); else return false;}
+    bool hasNext();
     bool prior();
     void first();
     void last(){}
+    void setBlockSize(int rows){ m_blockSize = rows; }
+    int blockSize() const { return m_blockSize; }
     bool bof(){return m_currentRow == -1;}
     bool eof(){return m_eof;}
     QVariant data(const QString &columnName);
@@ -432,6 +522,11 @@ private:
     bool checkNextRecord(int recordNum);
     bool checkIfEmpty();
     QVariant callbackData(const QString& columnName, int row);
+    bool isBlockMode();
+    bool blockRowExists(int row);
+    void fetchBlock(int row);
+    void clearBlock();
+    QVariant blockData(const QString& columnName, int row);
 private:
     QVector<QString> m_headers;
     int m_currentRow;
@@ -441,6 +536,11 @@ private:
     QHash<QString, QVariant> m_valuesCache;
     bool m_getDataFromCache;
     int m_lastKeyRow;
+    QVector<QVariantList> m_block;
+    QHash<QString, int> m_blockColumns;
+    int m_blockSize;
+    int m_blockStart;
+    bool m_blockAtEnd;
 };
 
 class CallbackDatasourceHolder :public QObject, public IDataSourceHolder{
@@ -29,12 +29,15 @@
  ****************************************************************************/
 #include "lrdatasourcemanager.h"
 #include "lrdatadesignintf.h"
+#include "lrcolumnardatasource.h"
+#include "lrqueryprefetch.h"
 #include <QStringList>
 #include <QSqlQuery>
 #include <QRegExp>
 #include <QSqlError>
 #include <QSqlQueryModel>
 #include <QFileInfo>
+#include <QThreadPool>
 #include <stdexcept>
 
 #ifdef BUILD_WITH_EASY_PROFILER
@@ -225,7 +228,8 @@ void DataSourceModel::updateModel()
 
 DataSourceManager::DataSourceManager(QObject *parent) :
     QObject(parent), m_lastError(""), m_designTime(false), m_needUpdate(false),
-    m_dbCredentialsProvider(0), m_hasChanges(false)
+    m_queriesDeferred(false), m_dbCredentialsProvider(0), m_queryPrefetchEnabled(false),
+    m_hasChanges(false)
 {
     m_groupFunctionFactory.registerFunctionCreator(QLatin1String("COUNT"),new ConstructorGroupFunctionCreator<CountGroupFunction>);
     m_groupFunctionFactory.registerFunctionCreator(QLatin1String("SUM"),new ConstructorGroupFunctionCreator<SumGroupFunction>);
@@ -299,12 +303,14 @@ void DataSourceManager::setDesignTime(bool designTime)
 
 DataSourceManager::~DataSourceManager()
 {
+    clearSortedDataSources();
     clear(All);
     clearGroupFunction();
 }
 
-void DataSourceManager::connectAllDatabases()
+void DataSourceManager::connectAllDatabases(bool deferQueries)
 {
+    m_queriesDeferred = deferQueries;
     foreach(ConnectionDesc* conn,m_connections){
         try{
             connectConnection(conn);
@@ -314,6 +320,57 @@ void DataSourceManager::connectAllDatabases()
             qDebug()<<e.what();
         }
     }
+    m_queriesDeferred = false;
+}
+
+void DataSourceManager::prefetchQueries()
+{
+    EASY_BLOCK("DataSourceManager::prefetchQueries");
+    RenderProfileScope profileScope(renderProfiler(), RenderProfiler::DataSource, "prefetch");
+    IDataSource::DatasourceMode mode = designTime() ? IDataSource::DESIGN_MODE : IDataSource::RENDER_MODE;
+    QList<QueryHolder*> holders;
+    QList<QueryPrefetchTask*> tasks;
+    foreach(QString datasourceName, dataSourceNames()){
+        if (!isQuery(datasourceName)) continue;
+        QueryHolder* qh = dynamic_cast<QueryHolder*>(dataSourceHolder(datasourceName));
+        // connections the application registered itself may carry settings
+        // a clone would not reproduce, they are left alone
+        if (qh && !isConnection(qh->connectionName())) continue;
+        if (qh && mode == IDataSource::RENDER_MODE && qh->needsRun(mode)){
+            QueryPrefetchTask* task = qh->createPrefetchTask();
+            if (task){
+                holders.append(qh);
+                tasks.append(task);
+            }
+        }
+    }
+
+    // a single query gains nothing from a worker thread, it runs on first use
+    if (tasks.count() > 1){
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMin(tasks.count(), QUERY_PREFETCH_MAX_THREADS));
+        foreach(QueryPrefetchTask* task, tasks)
+            pool.start(task);
+        pool.waitForDone();
+        for (int i = 0; i < tasks.count(); ++i){
+            // failed queries are left to run on first use so that errors are reported as before
+            if (tasks.at(i)->isSucceeded())
+                holders.at(i)->setPrefetchedResult(*tasks.at(i));
+        }
+    }
+    qDeleteAll(tasks);
+
+    foreach(QString datasourceName, dataSourceNames()){
+        if (isQuery(datasourceName))
+            invalidateChildren(datasourceName);
+    }
+    foreach(QString datasourceName, dataSourceNames()){
+        if (isProxy(datasourceName)){
+            ProxyHolder* ph = dynamic_cast<ProxyHolder*>(dataSourceHolder(datasourceName));
+            if (ph) ph->invalidate(mode);
+        }
+    }
+    EASY_END_BLOCK;
 }
 
 bool DataSourceManager::addModel(const QString &name, QAbstractItemModel *model, bool owned)
@@ -333,6 +390,23 @@ bool DataSourceManager::addModel(const QString &name, QAbstractItemModel *model,
     return true;
 }
 
+bool DataSourceManager::addColumnarData(const QString &name, const ColumnarDataTable &table)
+{
+    if (m_datasources.contains(name.toLower()))
+        removeDatasource(name.toLower());
+    IDataSourceHolder* holder = new CallbackDatasourceHolder(new ColumnarDataSource(table), true);
+    try{
+        putHolder(name, holder);
+    } catch (ReportError &e){
+        delete holder;
+        putError(e.what());
+        setLastError(e.what());
+        return false;
+    }
+    emit datasourcesChanged();
+    return true;
+}
+
 void DataSourceManager::removeModel(const QString &name)
 {
     if (m_datasources.contains(name.toLower()))
@@ -539,6 +613,21 @@ void DataSourceManager::addSubQuery(const QString &name, const QString &sqlText,
     emit datasourcesChanged();
 }
 
+void DataSourceManager::setSubQueryBatchMode(const QString &name, const QString &batchKeyField, int batchSize)
+{
+    SubQueryDesc* subQueryDesc = subQueryByName(name);
+    if (subQueryDesc){
+        subQueryDesc->setBatchKeyField(batchKeyField);
+        subQueryDesc->setBatchSize(batchSize);
+        SubQueryHolder* holder = dynamic_cast<SubQueryHolder*>(dataSourceHolder(name));
+        if (holder){
+            holder->setBatchKeyField(batchKeyField);
+            holder->setBatchSize(batchSize);
+        }
+        m_hasChanges = true;
+    }
+}
+
 void DataSourceManager::addProxy(const QString &name, const QString &master, const QString &detail, QList<FieldsCorrelation> fields)
 {
     ProxyDesc *proxyDesc = new ProxyDesc();
@@ -554,9 +643,21 @@ void DataSourceManager::addProxy(const QString &name, const QString &master, con
     emit datasourcesChanged();
 }
 
-void DataSourceManager::addCSV(const QString& name, const QString& csvText, const QString &separator, bool firstRowIsHeader)
+void DataSourceManager::addCSV(const QString& name, const QString& csvText, const QString &separator, bool firstRowIsHeader, bool inferTypes)
 {
     CSVDesc* csvDesc = new CSVDesc(name, csvText, separator, firstRowIsHeader);
+    csvDesc->setInferTypes(inferTypes);
+    putCSVDesc(csvDesc);
+    putHolder(name, new CSVHolder(*csvDesc, this));
+    m_hasChanges = true;
+    emit datasourcesChanged();
+}
+
+void DataSourceManager::addCSVFile(const QString &name, const QString &fileName, const QString &separator, bool firstRowIsHeader, bool inferTypes)
+{
+    CSVDesc* csvDesc = new CSVDesc(name, "", separator, firstRowIsHeader);
+    csvDesc->setFileName(fileName);
+    csvDesc->setInferTypes(inferTypes);
     putCSVDesc(csvDesc);
     putHolder(name, new CSVHolder(*csvDesc, this));
     m_hasChanges = true;
@@ -904,14 +1005,16 @@ bool DataSourceManager::connectConnection(ConnectionDesc *connectionDesc)
         foreach(QString datasourceName, dataSourceNames()){
             if (isQuery(datasourceName)){
                QueryHolder* qh = dynamic_cast<QueryHolder*>(dataSourceHolder(datasourceName));
-               if (qh){
+               if (qh && m_queriesDeferred){
+                   qh->discardResult();
+               } else if (qh){
                    qh->invalidate(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE);
                    invalidateChildren(datasourceName);
                }
             }
         }
         foreach(QString datasourceName, dataSourceNames()){
-            if (isProxy(datasourceName)){
+            if (isProxy(datasourceName) && !m_queriesDeferred){
                ProxyHolder* ph = dynamic_cast<ProxyHolder*>(dataSourceHolder(datasourceName));
                if (ph){
                    ph->invalidate(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE);
@@ -963,6 +1066,7 @@ void DataSourceManager::invalidateChildren(const QString &parentDatasourceName)
         SubQueryHolder* sh = dynamic_cast<SubQueryHolder*>(dataSourceHolder(datasourceName));
         if (sh)
             sh->invalidate(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE);
+        if (!m_sortedDatasources.isEmpty()) updateSortedDataSource(datasourceName);
         invalidateChildren(datasourceName);
     }
 }
@@ -1008,6 +1112,7 @@ bool DataSourceManager::connectConnection(const QString& connectionName)
 
 void DataSourceManager::disconnectConnection(const QString& connectionName)
 {
+    m_queryResultCache.clear(connectionName);
     foreach(QString datasourceName, dataSourceNames()){
         if (isQuery(datasourceName) || isSubQuery(datasourceName)){
             QueryHolder* qh = dynamic_cast<QueryHolder*>(dataSourceHolder(datasourceName));
@@ -1034,10 +1139,20 @@ IDataSource *DataSourceManager::dataSource(const QString &name)
     IDataSourceHolder* holder = m_datasources.value(name.toLower());
     if (holder) {
         if (holder->isInvalid()) {
+            if (!m_sortedDatasources.isEmpty()) updateSortedDataSource(name);
             setLastError(name+" : "+holder->lastError());
             return 0;
         } else {
-            return holder->dataSource(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE);
+            IDataSource* source = holder->dataSource(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE);
+            if (!m_sortedDatasources.isEmpty()){
+                SortedDataSource* sorted = m_sortedDatasources.value(name.toLower());
+                if (sorted){
+                    // the holder has been reopened since the view was sorted
+                    if (sorted->source() != source) sorted->setSource(source);
+                    return sorted;
+                }
+            }
+            return source;
         }
     } else {
         setLastError(tr("Datasource \"%1\" not found!").arg(name));
@@ -1045,6 +1160,40 @@ IDataSource *DataSourceManager::dataSource(const QString &name)
     }
 }
 
+IDataSource *DataSourceManager::sortDataSource(const QString &name, const QString &sortBy)
+{
+    removeSortedDataSource(name);
+    IDataSource* source = dataSource(name);
+    if (!source || sortBy.trimmed().isEmpty()) return source;
+    SortedDataSource* sorted = new SortedDataSource(source, sortBy);
+    if (!sorted->lastError().isEmpty() && !source->isInvalid())
+        putError(name+" : "+sorted->lastError());
+    m_sortedDatasources.insert(name.toLower(), sorted);
+    return sorted;
+}
+
+void DataSourceManager::updateSortedDataSource(const QString &name)
+{
+    SortedDataSource* sorted = m_sortedDatasources.value(name.toLower());
+    if (!sorted) return;
+    IDataSourceHolder* holder = m_datasources.value(name.toLower());
+    if (holder && !holder->isInvalid())
+        sorted->setSource(holder->dataSource(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE));
+    else
+        sorted->setSource(0);
+}
+
+void DataSourceManager::removeSortedDataSource(const QString &name)
+{
+    delete m_sortedDatasources.take(name.toLower());
+}
+
+void DataSourceManager::clearSortedDataSources()
+{
+    qDeleteAll(m_sortedDatasources);
+    m_sortedDatasources.clear();
+}
+
 IDataSourceHolder *DataSourceManager::dataSourceHolder(const QString &name)
 {
     if (m_datasources.value(name.toLower())) return m_datasources.value(name.toLower());
@@ -1223,12 +1372,14 @@ void DataSourceManager::collectionLoadFinished(const QString &collectionName)
             if (!m_datasources.contains(it.value()->queryName().toLower())){
                 connect(it.value(), SIGNAL(queryTextChanged(QString,QString)),
                         this, SLOT(slotQueryTextChanged(QString,QString)));
-                putHolder(it.value()->queryName(),new SubQueryHolder(
+                SubQueryHolder* holder = new SubQueryHolder(
                               it.value()->queryText(),
                               it.value()->connectionName(),
                               it.value()->master(),
-                              this)
-                );
+                              this);
+                holder->setBatchKeyField(it.value()->batchKeyField());
+                holder->setBatchSize(it.value()->batchSize());
+                putHolder(it.value()->queryName(), holder);
             } else {
                 delete it.value();
                 it.remove();
@@ -1310,6 +1461,8 @@ void DataSourceManager::addVariable(const QString &name, const QVariant &value,
 
 void DataSourceManager::deleteVariable(const QString& name)
 {
+    int slot = m_renderVariableSlots.value(name, -1);
+    if (slot != -1) unsetRenderVariable(slot);
     m_userVariables.deleteVariable(name);
     if (m_reportVariables.containsVariable(name)&&m_reportVariables.variableType(name)==VarDesc::Report){
         m_reportVariables.deleteVariable(name);
@@ -1322,6 +1475,11 @@ void DataSourceManager::deleteVariable(const QString& name)
 
 void DataSourceManager::changeVariable(const QString& name,const QVariant& value)
 {
+    int slot = m_renderVariableSlots.value(name, -1);
+    if (slot != -1 && m_renderVariables.at(slot).isSet){
+        setRenderVariable(slot, m_renderVariables.at(slot).isBool ? value.toBool() : value.toInt());
+        return;
+    }
     if (m_userVariables.containsVariable(name)){
         m_userVariables.changeVariable(name,value);
     }
@@ -1331,6 +1489,34 @@ void DataSourceManager::changeVariable(const QString& name,const QVariant& value
 
 }
 
+int DataSourceManager::renderVariableSlot(const QString &name, bool isBool)
+{
+    int slot = m_renderVariableSlots.value(name, -1);
+    if (slot == -1){
+        RenderVariable var;
+        var.name = name;
+        var.isBool = isBool;
+        m_renderVariables.append(var);
+        slot = m_renderVariables.count()-1;
+        m_renderVariableSlots.insert(name, slot);
+    }
+    return slot;
+}
+
+void DataSourceManager::setRenderVariable(int slot, int value)
+{
+    RenderVariable& var = m_renderVariables[slot];
+    var.value = value;
+    var.isSet = true;
+}
+
+void DataSourceManager::incrementRenderVariable(int slot)
+{
+    RenderVariable& var = m_renderVariables[slot];
+    var.value++;
+    var.isSet = true;
+}
+
 void DataSourceManager::setSystemVariable(const QString &name, const QVariant &value, RenderPass pass)
 {
     addVariable(name,value,VarDesc::System,pass);
@@ -1386,6 +1572,7 @@ void DataSourceManager::invalidateQueriesContainsVariable(const QString& variabl
             foreach(QString datasourceName, m_varToDataSource.value(variableName)){
                 QueryHolder* holder = dynamic_cast<QueryHolder*>(m_datasources.value(datasourceName));
                 if (holder) holder->invalidate(designTime() ? IDataSource::DESIGN_MODE : IDataSource::RENDER_MODE);
+                if (!m_sortedDatasources.isEmpty()) updateSortedDataSource(datasourceName);
             }
         } else {
             QVector<QString> datasources;
@@ -1395,6 +1582,7 @@ void DataSourceManager::invalidateQueriesContainsVariable(const QString& variabl
                     QRegExp rx(QString(Const::NAMED_VARIABLE_RX).arg(variableName));
                     if  (holder->queryText().contains(rx)){
                         holder->invalidate(designTime() ? IDataSource::DESIGN_MODE : IDataSource::RENDER_MODE);
+                        if (!m_sortedDatasources.isEmpty()) updateSortedDataSource(datasourceName);
                         datasources.append(datasourceName);
                     }
                 }
@@ -1429,6 +1617,7 @@ void DataSourceManager::slotCSVTextChanged(const QString &csvName, const QString
 void DataSourceManager::clear(ClearMethod method)
 {
     m_varToDataSource.clear();
+    clearSortedDataSources();
 
     DataSourcesMap::iterator dit;
     for( dit = m_datasources.begin(); dit != m_datasources.end(); ){
@@ -1551,13 +1740,19 @@ bool DataSourceManager::containsField(const QString &fieldName)
 bool DataSourceManager::containsVariable(const QString& variableName)
 {
     if (m_userVariables.containsVariable(variableName)) return true;
-    return m_reportVariables.containsVariable(variableName);
+    if (m_reportVariables.containsVariable(variableName)) return true;
+    int slot = m_renderVariableSlots.value(variableName, -1);
+    return slot != -1 && m_renderVariables.at(slot).isSet;
 }
 
 void DataSourceManager::clearUserVariables()
 {
     m_userVariables.clearUserVariables();
     m_reportVariables.clearUserVariables();
+    for (int i = 0; i < m_renderVariables.count(); ++i){
+        if (!m_reportVariables.containsVariable(m_renderVariables.at(i).name))
+            m_renderVariables[i].isSet = false;
+    }
 }
 
 QVariant DataSourceManager::fieldData(const QString &fieldName)
@@ -1594,42 +1789,44 @@ void DataSourceManager::reopenDatasource(const QString& datasourceName)
     QueryHolder* qh = dynamic_cast<QueryHolder*>(dataSourceHolder(datasourceName));
     if (qh){
         qh->invalidate(designTime()?IDataSource::DESIGN_MODE:IDataSource::RENDER_MODE);
+        if (!m_sortedDatasources.isEmpty()) updateSortedDataSource(datasourceName);
         invalidateChildren(datasourceName);
     }
 }
 
 QVariant DataSourceManager::variable(const QString &variableName)
 {
-    if (m_userVariables.containsVariable(variableName))
-        return m_userVariables.variable(variableName);
-    return m_reportVariables.variable(variableName);
+    int slot = m_renderVariableSlots.value(variableName, -1);
+    if (slot != -1 && m_renderVariables.at(slot).isSet){
+        const RenderVariable& var = m_renderVariables.at(slot);
+        return var.isBool ? QVariant(var.value != 0) : QVariant(var.value);
+    }
+    VarDesc* var = m_userVariables.variableByName(variableName);
+    if (!var) var = m_reportVariables.variableByName(variableName);
+    return var ? var->value() : QVariant();
 }
 
 RenderPass DataSourceManager::variablePass(const QString &name)
 {
-    if (m_userVariables.containsVariable(name))
-        return m_userVariables.variablePass(name);
+    VarDesc* var = m_userVariables.variableByName(name);
+    if (var) return var->renderPass();
     return m_reportVariables.variablePass(name);
 }
 
 bool DataSourceManager::variableIsSystem(const QString &name)
 {
-    if (m_reportVariables.containsVariable(name))
-        return (m_reportVariables.variableType(name)==VarDesc::System);
-    return false;
+    VarDesc* var = m_reportVariables.variableByName(name);
+    return var && var->varType() == VarDesc::System;
 }
 
 bool DataSourceManager::variableIsMandatory(const QString& name)
 {
-    if (m_reportVariables.containsVariable(name))
-        return m_reportVariables.variableByName(name)->isMandatory();
-    return false;
+    return m_reportVariables.variableIsMandatory(name);
 }
 
 void DataSourceManager::setVarableMandatory(const QString& name, bool value)
 {
-    if (m_reportVariables.containsVariable(name))
-        m_reportVariables.variableByName(name)->setMandatory(value);
+    m_reportVariables.setVarableMandatory(name, value);
 }
 
 QStringList DataSourceManager::variableNames()
@@ -1637,15 +1834,9 @@ QStringList DataSourceManager::variableNames()
     return m_reportVariables.variableNames();
 }
 
-QStringList DataSourceManager::variableNamesByRenderPass(RenderPass pass)
+const QStringList& DataSourceManager::variableNamesByRenderPass(RenderPass pass)
 {
-    QStringList result;
-    foreach(QString variableName, m_reportVariables.variableNames()){
-        if (m_reportVariables.variablePass(variableName) == pass){
-            result.append(variableName);
-        }
-    }
-    return result;
+    return m_reportVariables.variableNamesByRenderPass(pass);
 }
 
 QStringList DataSourceManager::userVariableNames(){
@@ -1654,22 +1845,26 @@ QStringList DataSourceManager::userVariableNames(){
 
 VarDesc::VarType DataSourceManager::variableType(const QString &name)
 {
-    if (m_reportVariables.containsVariable(name))
-        return m_reportVariables.variableType(name);
-    return VarDesc::User;
+    VarDesc* var = m_reportVariables.variableByName(name);
+    return var ? var->varType() : VarDesc::User;
 }
 
 VariableDataType DataSourceManager::variableDataType(const QString& name)
 {
-    if (m_reportVariables.containsVariable(name))
-        return m_reportVariables.variableByName(name)->dataType();
-    return Enums::Undefined;
+    return m_reportVariables.variableDataType(name);
 }
 
 void DataSourceManager::setVariableDataType(const QString& name, VariableDataType value)
 {
-    if (m_reportVariables.containsVariable(name))
-        m_reportVariables.variableByName(name)->setDataType(value);
+    m_reportVariables.setVariableDataType(name, value);
+}
+
+void DataSourceManager::releasePreparedQueries()
+{
+    foreach(IDataSourceHolder* holder, m_datasources.values()){
+        QueryHolder* qh = dynamic_cast<QueryHolder*>(holder);
+        if (qh) qh->releasePreparedQuery();
+    }
 }
 
 void DataSourceManager::setAllDatasourcesToFirst()
@@ -39,6 +39,9 @@
 #include "lrgroupfunctions.h"
 #include "lrdatasourcemanagerintf.h"
 #include "lrdatasourceintf.h"
+#include "lrqueryresultcache.h"
+#include "lrrenderprofiler.h"
+#include "lrsorteddatasource.h"
 
 namespace LimeReport{
 
@@ -107,15 +110,31 @@ public:
     typedef QHash<QString,IDataSourceHolder*> DataSourcesMap;
     enum ClearMethod {All,Owned};
     ~DataSourceManager();
-    void connectAllDatabases();
+    void connectAllDatabases(bool deferQueries = false);
+    void prefetchQueries();
+    void setQueryPrefetchEnabled(bool value){ m_queryPrefetchEnabled = value; }
+    bool isQueryPrefetchEnabled(){ return m_queryPrefetchEnabled; }
+    void setQueryResultCacheLimit(int maxCells){ m_queryResultCache.setMaxCells(maxCells); }
+    void setQueryResultCacheTTL(int seconds){ m_queryResultCache.setTimeToLive(seconds); }
+    void clearQueryResultCache(const QString& connectionName = QString()){ m_queryResultCache.clear(connectionName); }
+    QueryResultCache* queryResultCache(){ return &m_queryResultCache; }
+    RenderProfiler* renderProfiler(){ return &m_renderProfiler; }
+    IDataSource* sortDataSource(const QString& name, const QString& sortBy);
+    // Re-sorts the view of name over the holder's current data, call after invalidating it
+    void updateSortedDataSource(const QString& name);
+    void removeSortedDataSource(const QString& name);
+    void clearSortedDataSources();
     void addConnection(const QString& connectionName);
     void addConnectionDesc(ConnectionDesc *);
     bool checkConnectionDesc(ConnectionDesc *connection);
     void addQuery(const QString& name, const QString& sqlText, const QString& connectionName="");
     void addSubQuery(const QString& name, const QString& sqlText, const QString& connectionName, const QString& masterDatasource);
+    void setSubQueryBatchMode(const QString& name, const QString& batchKeyField, int batchSize);
     void addProxy(const QString& name, const QString& master, const QString& detail, QList<FieldsCorrelation> fields);
-    void addCSV(const QString& name, const QString& csvText, const QString& separator, bool firstRowIsHeader);
+    void addCSV(const QString& name, const QString& csvText, const QString& separator, bool firstRowIsHeader, bool inferTypes = false);
+    void addCSVFile(const QString& name, const QString& fileName, const QString& separator, bool firstRowIsHeader, bool inferTypes = false);
     bool addModel(const QString& name, QAbstractItemModel *model, bool owned);
+    bool addColumnarData(const QString& name, const ColumnarDataTable& table);
     void removeModel(const QString& name);
     ICallbackDatasource* createCallbackDatasource(const QString &name);
     void registerDbCredentialsProvider(IDbCredentialsProvider *provider);
@@ -129,7 +148,7 @@ public:
     QVariant    variable(const QString& variableName);
     RenderPass  variablePass(const QString& name);
     QStringList variableNames();
-    QStringList variableNamesByRenderPass(RenderPass pass);
+    const QStringList& variableNamesByRenderPass(RenderPass pass);
     QStringList userVariableNames();
     VarDesc::VarType   variableType(const QString& name);
     VariableDataType   variableDataType(const QString& name);
@@ -180,6 +199,7 @@ public:
             QVariant keyValue
     );
     void    reopenDatasource(const QString& datasourceName);
+    void    releasePreparedQueries();
 
     QString extractDataSource(const QString& fieldName);
     QString extractFieldName(const QString& fieldName);
@@ -222,6 +242,13 @@ public:
 
     bool hasChanges(){ return m_hasChanges; }
     void dropChanges(){ m_hasChanges = false; }
+
+    int  renderVariableSlot(const QString& name, bool isBool = false);
+    bool isRenderVariableSet(int slot) const { return m_renderVariables.at(slot).isSet; }
+    int  renderVariable(int slot) const { return m_renderVariables.at(slot).value; }
+    void setRenderVariable(int slot, int value);
+    void incrementRenderVariable(int slot);
+    void unsetRenderVariable(int slot){ m_renderVariables[slot].isSet = false; }
 signals:
     void loadCollectionFinished(const QString& collectionName);
     void cleared();
@@ -275,6 +302,7 @@ private:
     QStringList m_errorsList;
     bool m_designTime;
     bool m_needUpdate;
+    bool m_queriesDeferred;
     QString m_defaultDatabasePath;
     ReportSettings* m_reportSettings;
     QHash<QString,int> m_groupFunctionsExpressionsMap;
@@ -283,6 +311,22 @@ private:
 
     QMap< QString, QVector<QString> > m_varToDataSource;
 
+    // Renderer owned counters (line_<band>, #PAGE, ...) live in typed slots:
+    // writing them does not go through VariablesHolder signals and query invalidation.
+    struct RenderVariable{
+        RenderVariable():isBool(false), isSet(false), value(0){}
+        QString name;
+        bool isBool;
+        bool isSet;
+        int  value;
+    };
+    QVector<RenderVariable> m_renderVariables;
+    QHash<QString, int> m_renderVariableSlots;
+    QueryResultCache m_queryResultCache;
+    RenderProfiler m_renderProfiler;
+    QHash<QString, SortedDataSource*> m_sortedDatasources;
+    bool m_queryPrefetchEnabled;
+
     bool m_hasChanges;
 };
 
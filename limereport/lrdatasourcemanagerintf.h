@@ -33,6 +33,7 @@
 #include "lrcallbackdatasourceintf.h"
 #include "lrglobal.h"
 #include "lrdatasourceintf.h"
+#include "lrcolumnardatatable.h"
 
 class QVariant;
 class QString;
@@ -66,6 +67,18 @@ public:
     virtual bool variableIsSystem(const QString& name) = 0;
     virtual IDataSource* dataSource(const QString& name) = 0;
     virtual IDataSourceHolder* dataSourceHolder(const QString& name) = 0;
+    // Not pure so that existing implementations keep compiling.
+    // maxCells == 0 (default) disables the query result cache; seconds == 0 keeps results until cleared
+    virtual void setQueryResultCacheLimit(int maxCells){ Q_UNUSED(maxCells) }
+    virtual void setQueryResultCacheTTL(int seconds){ Q_UNUSED(seconds) }
+    virtual void clearQueryResultCache(const QString& connectionName = QString()){ Q_UNUSED(connectionName) }
+    virtual bool addColumnarData(const QString& name, const ColumnarDataTable& table){
+        Q_UNUSED(name) Q_UNUSED(table) return false;
+    }
+    // Run independent report queries in parallel at render start; off by default.
+    // Only connections described in the report are cloned for this.
+    virtual void setQueryPrefetchEnabled(bool value){ Q_UNUSED(value) }
+    virtual bool isQueryPrefetchEnabled(){ return false; }
 };
 
 }
@@ -49,6 +49,7 @@
 #include "lrexportersfactory.h"
 #include "lrexporterintf.h"
 #include "exporters/lrpdfexporter.h"
+#include "exporters/lrimageexporter.h"
 
 void initResources(){
     Q_INIT_RESOURCE(report);
@@ -490,6 +491,10 @@ LimeReport::ReportExporterInterface* createPDFExporter(ReportEnginePrivate* pare
     return new LimeReport::PDFExporter(parent);
 }
 
+LimeReport::ReportExporterInterface* createImageExporter(ReportEnginePrivate* parent){
+    return new LimeReport::ImageExporter(parent);
+}
+
 void initExporters()
 {
     ExportersFactory::instance().registerCreator(
@@ -497,6 +502,11 @@ void initExporters()
                 LimeReport::ExporterAttribs(QObject::tr("Export to PDF"), "PDFExporter"),
                 createPDFExporter
     );
+    ExportersFactory::instance().registerCreator(
+                "IMAGE",
+                LimeReport::ExporterAttribs(QObject::tr("Export to image"), "ImageExporter"),
+                createImageExporter
+    );
 }
 
 } //namespace LimeReport
@@ -29,6 +29,7 @@
  ****************************************************************************/
 #include <QString>
 #include <QDebug>
+#include <QApplication>
 #include "lrglobal.h"
 
 namespace LimeReport {
@@ -85,6 +86,17 @@ bool isColorDark(QColor color){
     }
 }
 
+bool isInteractiveSession()
+{
+    if (!qobject_cast<QApplication*>(QCoreApplication::instance())) return false;
+#ifdef HAVE_QT5
+    QString platform = QGuiApplication::platformName();
+    return platform != "offscreen" && platform != "minimal";
+#else
+    return true;
+#endif
+}
+
 ReportError::ReportError(const QString& message):std::runtime_error(message.toStdString()){}
 IExternalPainter::~IExternalPainter(){}
 IPainterProxy::~IPainterProxy(){}
@@ -93,6 +93,16 @@ namespace Const{
     const QString EOW("~!@#$%^&*()+{}|:\"<>?,/;'[]\\-=");
     const int DEFAULT_TAB_INDENTION = 4;
     const int DOCKWIDGET_MARGINS = 4;
+    const int PREVIEW_ZOOM_SETTLE_TIME = 200;
+    const int QUERY_PREFETCH_MAX_THREADS = 8;
+    const int SORT_PARALLEL_THRESHOLD = 100000;
+    const int COMPILED_SCRIPTS_CACHE_LIMIT = 1024;
+    const int SUBQUERY_BATCH_MAX_KEYS = 500;
+    const int SVG_RENDER_CACHE_LIMIT = 256;
+    const int SVG_RASTER_CACHE_SIZES = 4;
+    const int PROFILE_SCRIPT_NAME_LENGTH = 80;
+    const int IMAGE_EXPORT_DPI = 150;
+    const int IMAGE_EXPORT_BUFFERS_PER_THREAD = 2;
 
     const char SCRIPT_SIGN = 'S';
     const char FIELD_SIGN = 'D';
@@ -103,6 +113,9 @@ namespace Const{
     QString replaceHTMLSymbols(const QString &value);
     QVector<QString> normalizeCaptures(const QRegExp &reg);
     bool isColorDark(QColor color);
+    // False without a QApplication or on a platform without a screen
+    // (offscreen, minimal): message boxes and dialogs are not shown then.
+    bool isInteractiveSession();
 
     enum ExpandType {EscapeSymbols, NoEscapeSymbols, ReplaceHTMLSymbols};
     enum RenderPass {FirstPass = 1, SecondPass = 2};
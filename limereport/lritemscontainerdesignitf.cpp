@@ -1,5 +1,6 @@
 #include "lritemscontainerdesignitf.h"
 #include "lritemdesignintf.h"
+#include "lrdatasourcemanager.h"
 
 namespace LimeReport {
 
@@ -52,6 +53,8 @@ void ItemsContainerDesignInft::arrangeSubItems(RenderPass pass, DataSourceManage
 
     foreach (PItemSortContainer item, m_containerItems) {
         if (item->m_item->isNeedUpdateSize(pass)){
+            RenderProfileScope profileScope(dataManager ? dataManager->renderProfiler() : 0,
+                                            RenderProfiler::ItemType, item->m_item->storageTypeName());
             item->m_item->updateItemSize(dataManager, pass);
             needArrage=true;
         }
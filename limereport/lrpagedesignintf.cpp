@@ -56,6 +56,7 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QApplication>
 #include <QMessageBox>
+#include <algorithm>
 
 
 namespace LimeReport
@@ -66,6 +67,17 @@ bool bandSortBandLessThen(const BandDesignIntf *c1, const BandDesignIntf *c2)
     return c1->geometry().top() < c2->geometry().top();
 }
 
+// the page and its bands only, a pixmap per report item costs more than it saves
+void setItemCacheMode(QGraphicsItem* page, QGraphicsItem::CacheMode mode)
+{
+    if (page->cacheMode() != mode)
+        page->setCacheMode(mode);
+    foreach (QGraphicsItem* band, page->childItems()) {
+        if (band->cacheMode() != mode)
+            band->setCacheMode(mode);
+    }
+}
+
 PageDesignIntf::PageDesignIntf(QObject *parent):
     QGraphicsScene(parent),
     m_pageItem(0),
@@ -92,7 +104,11 @@ PageDesignIntf::PageDesignIntf(QObject *parent):
     m_joinItem(0),
     m_magneticMovement(false),
     m_reportSettings(0),
-    m_currentPage(0)
+    m_currentPage(0),
+    m_virtualPages(false),
+    m_pagesPrefetchCount(2),
+    m_maxVisiblePagesCount(32),
+    m_pagesCacheMode(QGraphicsItem::NoCache)
 {
     m_reportEditor = dynamic_cast<ReportEnginePrivate *>(parent);
     updatePageRect();
@@ -107,7 +123,8 @@ PageDesignIntf::~PageDesignIntf()
         m_pageItem.clear();
     }
     foreach (PageItemDesignIntf::Ptr pageItem, m_reportPages) {
-       removeItem(pageItem.data());
+        if (pageItem->scene() == this)
+            removeItem(pageItem.data());
     }
     m_commandsList.clear();
 }
@@ -277,6 +294,22 @@ void PageDesignIntf::setPageItem(PageItemDesignIntf::Ptr pageItem)
 }
 
 void PageDesignIntf::setPageItems(QList<PageItemDesignIntf::Ptr> pages)
+{
+    m_virtualPages = false;
+    layoutPageItems(pages);
+    foreach (PageItemDesignIntf::Ptr pageItem, pages) {
+        if (pageItem->scene() != this)
+            addItem(pageItem.data());
+    }
+}
+
+void PageDesignIntf::setVirtualPageItems(QList<PageItemDesignIntf::Ptr> pages)
+{
+    m_virtualPages = true;
+    layoutPageItems(pages);
+}
+
+void PageDesignIntf::layoutPageItems(QList<PageItemDesignIntf::Ptr> pages)
 {
     m_currentPage = 0;
     if (!m_pageItem.isNull()) {
@@ -284,14 +317,16 @@ void PageDesignIntf::setPageItems(QList<PageItemDesignIntf::Ptr> pages)
             removeItem(m_pageItem.data());
         m_pageItem.clear();
     }
+    clearVisiblePages();
     int curHeight = 0;
     int curWidth = 0;
     m_reportPages = pages;
+    m_pagePositions.clear();
+    m_pagePositions.reserve(pages.count());
     foreach (PageItemDesignIntf::Ptr pageItem, pages) {
-        pageItem->setItemMode(itemMode());
-        addItem(pageItem.data());
         registerItem(pageItem.data());
         pageItem->setPos(0,curHeight);
+        m_pagePositions.append(curHeight);
         curHeight+=pageItem->height()+20;
         if (curWidth<pageItem->width()) curWidth=pageItem->width();
     }
@@ -304,6 +339,98 @@ void PageDesignIntf::setPageItems(QList<PageItemDesignIntf::Ptr> pages)
 
 }
 
+int PageDesignIntf::pageIndexAt(qreal y) const
+{
+    if (m_pagePositions.isEmpty()) return -1;
+    QVector<qreal>::const_iterator it = std::upper_bound(m_pagePositions.constBegin(), m_pagePositions.constEnd(), y);
+    if (it == m_pagePositions.constBegin()) return 0;
+    return (it - m_pagePositions.constBegin()) - 1;
+}
+
+void PageDesignIntf::updateVisiblePages(const QRectF& visibleRect)
+{
+    if (!m_virtualPages || m_reportPages.isEmpty()) return;
+
+    int firstPage = qMax(0, pageIndexAt(visibleRect.top()) - m_pagesPrefetchCount);
+    int lastPage = qMin(m_reportPages.count() - 1, pageIndexAt(visibleRect.bottom()) + m_pagesPrefetchCount);
+
+    for (int i = firstPage; i <= lastPage; ++i){
+        materializePage(m_reportPages.at(i));
+    }
+
+    // least recently shown pages are at the head of the list
+    int maxCount = qMax(m_maxVisiblePagesCount, lastPage - firstPage + 1);
+    while (m_visiblePages.count() > maxCount){
+        PageItemDesignIntf::Ptr page = m_visiblePages.takeFirst();
+        if (page->scene() == this)
+            removeItem(page.data());
+        setItemCacheMode(page.data(), QGraphicsItem::NoCache);
+        page->releaseContent();
+    }
+}
+
+void PageDesignIntf::materializePage(PageItemDesignIntf::Ptr page)
+{
+    int index = m_visiblePages.indexOf(page);
+    if (index != -1) {
+        m_visiblePages.move(index, m_visiblePages.count() - 1);
+    } else {
+        m_visiblePages.append(page);
+    }
+    if (page->scene() != this){
+        page->restoreContent();
+        applyPageCacheMode(page.data());
+        addItem(page.data());
+    }
+}
+
+void PageDesignIntf::setPagesCacheMode(QGraphicsItem::CacheMode mode)
+{
+    if (m_pagesCacheMode == mode) return;
+    m_pagesCacheMode = mode;
+    foreach (PageItemDesignIntf::Ptr page, m_visiblePages) {
+        applyPageCacheMode(page.data());
+    }
+}
+
+void PageDesignIntf::applyPageCacheMode(PageItemDesignIntf* page)
+{
+    // the page being edited is painted directly so that changes are visible at once
+    if (page == m_currentPage && m_itemMode == DesignMode)
+        setItemCacheMode(page, QGraphicsItem::NoCache);
+    else
+        setItemCacheMode(page, m_pagesCacheMode);
+}
+
+QImage PageDesignIntf::renderPageToImage(PageItemDesignIntf* page, const QSize& imageSize)
+{
+    PageContentGuard contentGuard(page);
+    QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
+    QRectF target(QPointF(0, 0), QSizeF(imageSize));
+    if (page->scene()){
+        page->scene()->render(&painter, target, page->mapRectToScene(page->rect()), Qt::IgnoreAspectRatio);
+    } else {
+        QGraphicsScene renderScene;
+        renderScene.addItem(page);
+        renderScene.render(&painter, target, page->mapRectToScene(page->rect()), Qt::IgnoreAspectRatio);
+        renderScene.removeItem(page);
+    }
+    return image;
+}
+
+void PageDesignIntf::clearVisiblePages()
+{
+    foreach (PageItemDesignIntf::Ptr page, m_visiblePages) {
+        if (page->scene() == this)
+            removeItem(page.data());
+        setItemCacheMode(page.data(), QGraphicsItem::NoCache);
+    }
+    m_visiblePages.clear();
+}
+
 void PageDesignIntf::removePageItem(PageItemDesignIntf::Ptr pageItem)
 {
     if (m_pageItem == pageItem){
@@ -974,6 +1101,8 @@ CommandIf::Ptr PageDesignIntf::createChangeSizeCommand()
 void PageDesignIntf::reactivatePageItem(PageItemDesignIntf::Ptr pageItem)
 {
     pageItem->setItemMode(itemMode());
+    if (m_virtualPages && !m_visiblePages.contains(pageItem))
+        return;
     if (pageItem.data()->scene()!=this)
         addItem(pageItem.data());
 }
@@ -1101,10 +1230,13 @@ PageItemDesignIntf* PageDesignIntf::getCurrentPage() const
 void PageDesignIntf::setCurrentPage(PageItemDesignIntf* currentPage)
 {
     if (m_currentPage != currentPage ){
+        PageItemDesignIntf* priorPage = m_currentPage;
         if (m_currentPage) m_currentPage->setItemMode(PreviewMode);
         m_currentPage = currentPage;
         if (m_itemMode == DesignMode){
             m_currentPage->setItemMode(DesignMode);
+            if (priorPage) applyPageCacheMode(priorPage);
+            if (m_currentPage) applyPageCacheMode(m_currentPage);
         }
     }
 }
@@ -1872,6 +2004,7 @@ void PageDesignIntf::setItemMode(BaseDesignIntf::ItemMode mode)
         m_itemMode = mode;
         if (m_currentPage) {
             m_currentPage->setItemMode(mode);
+            applyPageCacheMode(m_currentPage);
         } else {
             foreach(QGraphicsItem * item, items()) {
                 BaseDesignIntf *reportItem = dynamic_cast<BaseDesignIntf *>(item);
@@ -113,6 +113,16 @@ namespace LimeReport {
         PageItemDesignIntf *pageItem();
         void setPageItem(PageItemDesignIntf::Ptr pageItem);
         void setPageItems(QList<PageItemDesignIntf::Ptr> pages);
+        void setVirtualPageItems(QList<PageItemDesignIntf::Ptr> pages);
+        void updateVisiblePages(const QRectF& visibleRect);
+        int  pageIndexAt(qreal y) const;
+        int  pagesPrefetchCount() const {return m_pagesPrefetchCount;}
+        void setPagesPrefetchCount(int value){m_pagesPrefetchCount = value;}
+        int  maxVisiblePagesCount() const {return m_maxVisiblePagesCount;}
+        void setMaxVisiblePagesCount(int value){m_maxVisiblePagesCount = value;}
+        QGraphicsItem::CacheMode pagesCacheMode() const {return m_pagesCacheMode;}
+        void setPagesCacheMode(QGraphicsItem::CacheMode mode);
+        static QImage renderPageToImage(PageItemDesignIntf* page, const QSize& imageSize);
         void removePageItem(PageItemDesignIntf::Ptr pageItem);
         QList<PageItemDesignIntf::Ptr> pageItems(){return m_reportPages;}
 
@@ -284,6 +294,10 @@ namespace LimeReport {
         void activateItemToJoin(QRectF itemRect, QList<ItemProjections>& items);
         void selectAllChildren(BaseDesignIntf* item);
         bool selectionContainsBand();
+        void layoutPageItems(QList<PageItemDesignIntf::Ptr> pages);
+        void materializePage(PageItemDesignIntf::Ptr page);
+        void clearVisiblePages();
+        void applyPageCacheMode(PageItemDesignIntf* page);
     private:
         enum JoinType{Width, Height};
         LimeReport::PageItemDesignIntf::Ptr m_pageItem;
@@ -324,7 +338,12 @@ namespace LimeReport {
         bool             m_magneticMovement;
         ReportSettings*  m_reportSettings;
         PageItemDesignIntf* m_currentPage;
-
+        bool             m_virtualPages;
+        QVector<qreal>   m_pagePositions;
+        QList<PageItemDesignIntf::Ptr> m_visiblePages;
+        int              m_pagesPrefetchCount;
+        int              m_maxVisiblePagesCount;
+        QGraphicsItem::CacheMode m_pagesCacheMode;
     };
 
     class AbstractPageCommand : public CommandIf{
@@ -30,6 +30,8 @@
 #include "lrpageitemdesignintf.h"
 #include "lrbanddesignintf.h"
 #include "lrpagedesignintf.h"
+#include "serializators/lrxmlreader.h"
+#include "serializators/lrxmlwriter.h"
 
 #include <QGraphicsScene>
 #include <QPrinter>
@@ -51,7 +53,8 @@ PageItemDesignIntf::PageItemDesignIntf(QObject *owner, QGraphicsItem *parent) :
     m_pageOrientaion(Portrait), m_pageSize(A4), m_sizeChainging(false),
     m_fullPage(false), m_oldPrintMode(false), m_resetPageNumber(false),
     m_isExtendedInDesignMode(false), m_extendedHeight(1000), m_isTOC(false), m_setPageSizeToPrinter(false),
-    m_endlessHeight(false), m_printable(true), m_pageFooter(0), m_printBehavior(Split)
+    m_endlessHeight(false), m_printable(true), m_pageFooter(0), m_printBehavior(Split),
+    m_bandNameIndexValid(false)
 {
     setFixedPos(true);
     setPossibleResizeDirectionFlags(Fixed);
@@ -65,7 +68,8 @@ PageItemDesignIntf::PageItemDesignIntf(const PageSize pageSize, const QRectF &re
     m_pageOrientaion(Portrait), m_pageSize(pageSize), m_sizeChainging(false),
     m_fullPage(false), m_oldPrintMode(false), m_resetPageNumber(false),
     m_isExtendedInDesignMode(false), m_extendedHeight(1000), m_isTOC(false), m_setPageSizeToPrinter(false),
-    m_endlessHeight(false), m_printable(true), m_pageFooter(0), m_printBehavior(Split)
+    m_endlessHeight(false), m_printable(true), m_pageFooter(0), m_printBehavior(Split),
+    m_bandNameIndexValid(false)
 {
     setFixedPos(true);
     setPossibleResizeDirectionFlags(Fixed);
@@ -174,6 +178,32 @@ void PageItemDesignIntf::clear()
     }
     childItems().clear();
     m_bands.clear();
+    m_bandNameIndexValid = false;
+}
+
+// Keeps the page compressed in XML form and deletes its items; used for
+// rendered pages that are not shown so that they do not occupy memory.
+void PageItemDesignIntf::releaseContent()
+{
+    if (isContentReleased() || childItems().isEmpty()) return;
+    QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
+    writer->putItem(this);
+    m_releasedContent = qCompress(writer->saveToByteArray());
+    clear();
+}
+
+void PageItemDesignIntf::restoreContent()
+{
+    if (!isContentReleased()) return;
+    QByteArray content = qUncompress(m_releasedContent);
+    m_releasedContent.clear();
+    QPointF position = pos();
+    ItemsReaderIntf::Ptr reader = ByteArrayXMLReader::create(&content);
+    if (reader->first())
+        reader->readItem(this);
+    setPos(position);
+    setItemMode(itemMode());
+    setReportSettings(reportSettings());
 }
 
 BandDesignIntf *PageItemDesignIntf::bandByType(BandDesignIntf::BandsType bandType) const
@@ -210,9 +240,23 @@ BandDesignIntf* PageItemDesignIntf::bandByIndex(int index)
 
 BandDesignIntf *PageItemDesignIntf::bandByName(QString bandObjectName)
 {
-    foreach(BandDesignIntf* band, childBands()){
-        if (band->objectName().compare(bandObjectName,Qt::CaseInsensitive)==0){
-            return band;
+    if (!m_bandNameIndexValid){
+        m_bandNameIndex.clear();
+        foreach(BandDesignIntf* band, childBands()){
+            QString key = band->objectName().toCaseFolded();
+            if (!m_bandNameIndex.contains(key))
+                m_bandNameIndex.insert(key, band);
+        }
+        m_bandNameIndexValid = true;
+    }
+    BandDesignIntf* band = m_bandNameIndex.value(bandObjectName.toCaseFolded());
+    if (band && band->objectName().compare(bandObjectName,Qt::CaseInsensitive)==0)
+        return band;
+    // renames are not tracked: a stale entry or a miss falls back to the scan
+    foreach(BandDesignIntf* item, childBands()){
+        if (item->objectName().compare(bandObjectName,Qt::CaseInsensitive)==0){
+            m_bandNameIndexValid = false;
+            return item;
         }
     }
     return 0;
@@ -325,6 +369,7 @@ void PageItemDesignIntf::registerBand(BandDesignIntf *band)
             m_bands.append(band);
         else
             m_bands.insert(band->bandIndex(), band);
+        m_bandNameIndexValid = false;
         band->setParent(this);
         band->setParentItem(this);
         band->setWidth(pageRect().width() / band->columnsCount());
@@ -576,6 +621,7 @@ void PageItemDesignIntf::removeBand(BandDesignIntf *band)
 {
     if (!m_bands.isEmpty()){
         m_bands.removeOne(band);
+        m_bandNameIndexValid = false;
     }
 }
 
@@ -929,6 +975,7 @@ void PageItemDesignIntf::collectionLoadFinished(const QString &collectionName)
 {
     if (collectionName.compare("children",Qt::CaseInsensitive)==0){
         m_bands.clear();
+        m_bandNameIndexValid = false;
 #ifdef HAVE_QT5
         foreach(QObject* obj,children()){
 #else
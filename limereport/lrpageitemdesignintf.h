@@ -104,6 +104,9 @@ public:
     virtual QRectF boundingRect() const;
     void setItemMode(LimeReport::BaseDesignIntf::ItemMode mode);
     void clear();
+    void releaseContent();
+    void restoreContent();
+    bool isContentReleased() const {return !m_releasedContent.isEmpty();}
     const BandsList& childBands() const {return m_bands;}
     BandDesignIntf * bandByType(BandDesignIntf::BandsType bandType) const;
     bool isBandExists(BandDesignIntf::BandsType bandType);
@@ -220,11 +223,32 @@ private:
     QString m_printerName;
     BandDesignIntf* m_pageFooter;
     PrintBehavior m_printBehavior;
-
+    QHash<QString, BandDesignIntf*> m_bandNameIndex;
+    bool m_bandNameIndexValid;
+    QByteArray m_releasedContent;
 
 };
 
 typedef QList<PageItemDesignIntf::Ptr> ReportPages;
 
+// Restores the content of a released preview page for the guard's lifetime,
+// so that pages are brought back one at a time while printing or saving.
+class PageContentGuard{
+public:
+    explicit PageContentGuard(PageItemDesignIntf* page)
+        : m_page(page), m_released(page->isContentReleased())
+    {
+        m_page->restoreContent();
+    }
+    ~PageContentGuard()
+    {
+        if (m_released) m_page->releaseContent();
+    }
+private:
+    Q_DISABLE_COPY(PageContentGuard)
+    PageItemDesignIntf* m_page;
+    bool m_released;
+};
+
 }
 #endif // LRPAGEITEM_H
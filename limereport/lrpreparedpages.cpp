@@ -28,6 +28,7 @@ bool PreparedPages::saveToFile(const QString &fileName)
     if (!fileName.isEmpty()){
         QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
         foreach (PageItemDesignIntf::Ptr page, *m_pages){
+            PageContentGuard contentGuard(page.data());
             writer->putItem(page.data());
         }
         return writer->saveToFile(fileName);
@@ -39,6 +40,7 @@ QString PreparedPages::saveToString()
 {
     QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
     foreach (PageItemDesignIntf::Ptr page, *m_pages){
+        PageContentGuard contentGuard(page.data());
         writer->putItem(page.data());
     }
     return writer->saveToString();
@@ -48,6 +50,7 @@ QByteArray PreparedPages::saveToByteArray()
 {
     QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
     foreach (PageItemDesignIntf::Ptr page, *m_pages){
+        PageContentGuard contentGuard(page.data());
         writer->putItem(page.data());
     }
     return writer->saveToByteArray();
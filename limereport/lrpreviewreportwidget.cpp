@@ -25,7 +25,7 @@ bool PreviewReportWidgetPrivate::pageIsVisible(){
         return false;
     PageItemDesignIntf::Ptr page = m_reportPages.at(m_currentPage-1);
     return page->mapToScene(page->rect()).boundingRect().intersects(
-                view->mapToScene(view->viewport()->geometry()).boundingRect()
+                view->mapToScene(view->viewport()->rect()).boundingRect()
                 );
 }
 
@@ -47,17 +47,25 @@ void PreviewReportWidgetPrivate::setPages(ReportPages pages)
 {
     m_reportPages = pages;
     if (!m_reportPages.isEmpty()){
-        m_previewPage->setPageItems(m_reportPages);
+        m_previewPage->setVirtualPageItems(m_reportPages);
+        m_thumbnails->setPages(m_reportPages);
         m_changingPage = true;
         m_currentPage = 1;
+        q_ptr->initPreview();
+        updateVisiblePages();
         if (pages.at(0)) pages.at(0)->setSelected(true);
         m_changingPage = false;
-        q_ptr->initPreview();
         q_ptr->emitPageSet();
         q_ptr->activateCurrentPage();
     }
 }
 
+void PreviewReportWidgetPrivate::updateVisiblePages()
+{
+    QGraphicsView* view = q_ptr->ui->graphicsView;
+    m_previewPage->updateVisiblePages(view->mapToScene(view->viewport()->rect()).boundingRect());
+}
+
 PageItemDesignIntf::Ptr PreviewReportWidgetPrivate::currentPage()
 {
     if (m_reportPages.count()>0 && m_reportPages.count() >= m_currentPage && m_currentPage > 0)
@@ -95,14 +103,22 @@ PreviewReportWidget::PreviewReportWidget(ReportEngine *report, QWidget *parent)
     d_ptr->m_report = report->d_ptr;
     d_ptr->m_previewPage = d_ptr->m_report->createPreviewPage();
     d_ptr->m_previewPage->setItemMode( LimeReport::PreviewMode );
+    d_ptr->m_previewPage->setPagesCacheMode(QGraphicsItem::DeviceCoordinateCache);
     m_resizeTimer.setSingleShot(true);
+    m_zoomTimer.setSingleShot(true);
 
     ui->errorsView->setVisible(false);
+    d_ptr->m_thumbnails = new PreviewThumbnailsModel(this);
+    ui->thumbnailsView->setModel(d_ptr->m_thumbnails);
+    ui->thumbnailsView->setIconSize(d_ptr->m_thumbnails->thumbnailSize());
+    ui->thumbnailsView->setVisible(false);
+    connect(ui->thumbnailsView, SIGNAL(clicked(QModelIndex)), this, SLOT(slotThumbnailActivated(QModelIndex)));
     connect(ui->graphicsView->verticalScrollBar(),SIGNAL(valueChanged(int)), this, SLOT(slotSliderMoved(int)));
     connect(d_ptr->m_report, SIGNAL(destroyed(QObject*)), this, SLOT(reportEngineDestroyed(QObject*)));
     d_ptr->m_zoomer = new GraphicsViewZoomer(ui->graphicsView);
     connect(d_ptr->m_zoomer, SIGNAL(zoomed(double)), this, SLOT(slotZoomed(double)));
     connect(&m_resizeTimer, SIGNAL(timeout()), this, SLOT(resizeDone()));
+    connect(&m_zoomTimer, SIGNAL(timeout()), this, SLOT(zoomDone()));
 }
 
 PreviewReportWidget::~PreviewReportWidget()
@@ -290,6 +306,7 @@ void PreviewReportWidget::saveToFile()
         if (!fileName.isEmpty()){
             QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
             foreach (PageItemDesignIntf::Ptr page, d_ptr->m_reportPages){
+                PageContentGuard contentGuard(page.data());
                 writer->putItem(page.data());
             }
             writer->saveToFile(fileName);
@@ -303,6 +320,7 @@ void PreviewReportWidget::setScalePercent(int percent)
     d_ptr->m_scalePercent = percent;
     qreal scaleSize = percent/100.0;
     ui->graphicsView->scale(scaleSize, scaleSize);
+    d_ptr->updateVisiblePages();
     emit scalePercentChanged(percent);
     if (percent == 100){
         m_scaleType = OneToOne;
@@ -419,13 +437,55 @@ void PreviewReportWidget::refreshPages()
 void PreviewReportWidget::activateCurrentPage()
 {
     PageDesignIntf* page = dynamic_cast<PageDesignIntf*>(ui->graphicsView->scene());
-    if (page)
+    if (page){
+        PageItemDesignIntf* priorPage = page->getCurrentPage();
+        if (priorPage && page->itemMode() == DesignMode && priorPage != d_ptr->currentPage().data()){
+            // the page could have been edited, its thumbnail is outdated
+            for (int i = 0; i < d_ptr->m_reportPages.count(); ++i){
+                if (d_ptr->m_reportPages.at(i).data() == priorPage){
+                    d_ptr->m_thumbnails->invalidate(i);
+                    break;
+                }
+            }
+        }
         page->setCurrentPage(d_ptr->currentPage().data());
+    }
+    if (ui->thumbnailsView->isVisible())
+        ui->thumbnailsView->setCurrentIndex(d_ptr->m_thumbnails->index(d_ptr->m_currentPage - 1));
+}
+
+bool PreviewReportWidget::thumbnailsVisible() const
+{
+    return !ui->thumbnailsView->isHidden();
+}
+
+void PreviewReportWidget::setThumbnailsVisible(bool visible)
+{
+    ui->thumbnailsView->setVisible(visible);
+}
+
+QString PreviewReportWidget::thumbnailsCachePath() const
+{
+    return d_ptr->m_thumbnails->diskCachePath();
+}
+
+void PreviewReportWidget::setThumbnailsCachePath(const QString& path)
+{
+    d_ptr->m_thumbnails->setDiskCachePath(path);
+}
+
+void PreviewReportWidget::slotThumbnailActivated(const QModelIndex& index)
+{
+    if (index.isValid()){
+        pageNavigatorChanged(index.row() + 1);
+        emit pageChanged(d_ptr->m_currentPage);
+    }
 }
 
 void PreviewReportWidget::slotSliderMoved(int value)
 {
     int curPage = d_ptr->m_currentPage;
+    d_ptr->updateVisiblePages();
     if (ui->graphicsView->verticalScrollBar()->minimum()==value){
         d_ptr->m_currentPage = 1;
     } else if (ui->graphicsView->verticalScrollBar()->maximum()==value){
@@ -433,11 +493,8 @@ void PreviewReportWidget::slotSliderMoved(int value)
     }
 
     if (!d_ptr->pageIsVisible()){
-        if (value>d_ptr->m_priorScrolValue){
-            d_ptr->m_currentPage++;
-        } else {
-            d_ptr->m_currentPage--;
-        }
+        qreal viewTop = ui->graphicsView->mapToScene(0, 0).y();
+        d_ptr->m_currentPage = d_ptr->m_previewPage->pageIndexAt(viewTop) + 1;
     }
 
     if (curPage != d_ptr->m_currentPage){
@@ -460,9 +517,19 @@ void PreviewReportWidget::reportEngineDestroyed(QObject *object)
 void PreviewReportWidget::slotZoomed(double )
 {
     d_ptr->m_scalePercent = ui->graphicsView->matrix().m11()*100;
+    // while zooming is in progress cached pixmaps are scaled, pages are
+    // rasterized again at the final scale when zooming settles
+    d_ptr->m_previewPage->setPagesCacheMode(QGraphicsItem::ItemCoordinateCache);
+    m_zoomTimer.start(Const::PREVIEW_ZOOM_SETTLE_TIME);
+    d_ptr->updateVisiblePages();
     emit scalePercentChanged(d_ptr->m_scalePercent);
 }
 
+void PreviewReportWidget::zoomDone()
+{
+    d_ptr->m_previewPage->setPagesCacheMode(QGraphicsItem::DeviceCoordinateCache);
+}
+
 void PreviewReportWidget::resizeDone()
 {
     switch (m_scaleType) {
@@ -40,6 +40,10 @@ public:
     void activateItemSelectionMode();
     void deleteSelectedItems();
     void activateCurrentPage();
+    bool thumbnailsVisible() const;
+    void setThumbnailsVisible(bool visible);
+    QString thumbnailsCachePath() const;
+    void setThumbnailsCachePath(const QString& path);
 
 public slots:
     void refreshPages();
@@ -71,6 +75,8 @@ private slots:
     void reportEngineDestroyed(QObject* object);
     void slotZoomed(double);
     void resizeDone();
+    void zoomDone();
+    void slotThumbnailActivated(const QModelIndex& index);
 private:
     void initPreview();
     void setErrorsMesagesVisible(bool visible);
@@ -82,6 +88,7 @@ private:
     ScaleType m_scaleType;
     int       m_scalePercent;
     QTimer    m_resizeTimer;
+    QTimer    m_zoomTimer;
     QColor    m_previewPageBackgroundColor;
     QPrinter* m_defaultPrinter;
     void printPages(QPrinter *printer);
@@ -4,6 +4,7 @@
 #include "lrpagedesignintf.h"
 #include "lrreportrender.h"
 #include "lrgraphicsviewzoom.h"
+#include "lrpreviewthumbnails.h"
 
 namespace LimeReport{
 
@@ -13,12 +14,13 @@ class PreviewReportWidgetPrivate
 {
 public:
     PreviewReportWidgetPrivate(PreviewReportWidget* previewReportWidget):
-      m_previewPage(NULL), m_report(NULL), m_zoomer(NULL),
+      m_previewPage(NULL), m_report(NULL), m_zoomer(NULL), m_thumbnails(NULL),
       m_currentPage(1), m_changingPage(false), m_priorScrolValue(0), m_scalePercent(50),
       q_ptr(previewReportWidget), m_previePageColor(Qt::white) {}
     bool pageIsVisible();
     QRectF calcPageShift();
     void setPages( ReportPages pages);
+    void updateVisiblePages();
     PageItemDesignIntf::Ptr currentPage();
     QList<QString> aviableExporters();
     void startInsertTextItem();
@@ -29,6 +31,7 @@ public:
     ReportPages     m_reportPages;
     ReportEnginePrivate* m_report;
     GraphicsViewZoomer* m_zoomer;
+    PreviewThumbnailsModel* m_thumbnails;
     int m_currentPage;
     bool m_changingPage;
     int m_priorScrolValue;
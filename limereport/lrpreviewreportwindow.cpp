@@ -535,6 +535,11 @@ void PreviewReportWindow::on_actionShow_Toolbar_triggered()
     writeSetting();
 }
 
+void PreviewReportWindow::on_actionShowThumbnails_toggled(bool value)
+{
+    m_previewReportWidget->setThumbnailsVisible(value);
+}
+
 void PreviewReportWindow::slotCurrentPageChanged(int /*page*/)
 {
     slotActivateItemSelectionMode();
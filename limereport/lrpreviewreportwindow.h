@@ -117,6 +117,7 @@ private slots:
     void slotScalePercentChanged(int percent);    
     void on_actionShowMessages_toggled(bool value);
     void on_actionShow_Toolbar_triggered();
+    void on_actionShowThumbnails_toggled(bool value);
     void slotCurrentPageChanged(int page);
     void slotItemInserted(LimeReport::PageDesignIntf* report, QPointF pos, const QString& ItemType);
     void slotPrintingStarted(int pageCount);
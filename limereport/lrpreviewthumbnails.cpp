@@ -0,0 +1,239 @@
+/***************************************************************************
+ *   This file is part of the Lime Report project                          *
+ *   Copyright (C) 2015 by Alexander Arin                                  *
+ *   arin_a@bk.ru                                                          *
+ *                                                                         *
+ **                   GNU General Public License Usage                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ **                  GNU Lesser General Public License                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation, either version 3 of the    *
+ *   License, or (at your option) any later version.                       *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library.                                      *
+ *   If not, see <http://www.gnu.org/licenses/>.                           *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ****************************************************************************/
+#include "lrpreviewthumbnails.h"
+#include "lrpagedesignintf.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QPixmap>
+#include <QRunnable>
+
+namespace LimeReport {
+
+namespace {
+
+const int THUMBNAILS_MEMORY_CACHE_LIMIT = 64 * 1024 * 1024;
+const int THUMBNAILS_PER_TICK = 2;
+
+QAtomicInt thumbnailsGeneration;
+
+// unique per set of pages, also between processes sharing the cache path
+QString newGeneration()
+{
+    return QString("%1_%2").arg(QCoreApplication::applicationPid())
+                           .arg(thumbnailsGeneration.fetchAndAddOrdered(1) + 1);
+}
+
+class ThumbnailWriter : public QRunnable{
+public:
+    ThumbnailWriter(const QString& fileName, const QImage& image)
+        : m_fileName(fileName), m_image(image){}
+    void run(){ m_image.save(m_fileName, "PNG"); }
+private:
+    QString m_fileName;
+    QImage m_image;
+};
+
+}
+
+PreviewThumbnailsModel::PreviewThumbnailsModel(QObject* parent)
+    : QAbstractListModel(parent), m_thumbnailSize(120, 170)
+{
+    m_thumbnails.setMaxCost(THUMBNAILS_MEMORY_CACHE_LIMIT);
+    m_generationTimer.setInterval(0);
+    connect(&m_generationTimer, SIGNAL(timeout()), this, SLOT(slotGenerateNext()));
+}
+
+PreviewThumbnailsModel::~PreviewThumbnailsModel()
+{
+    clearDiskCache();
+}
+
+void PreviewThumbnailsModel::setPages(ReportPages pages)
+{
+    beginResetModel();
+    m_generationTimer.stop();
+    m_requests.clear();
+    m_thumbnails.clear();
+    clearDiskCache();
+    m_generation = newGeneration();
+    m_pages = pages;
+    m_placeholder = QImage();
+    endResetModel();
+}
+
+QSize PreviewThumbnailsModel::thumbnailSize() const
+{
+    return m_thumbnailSize;
+}
+
+void PreviewThumbnailsModel::setThumbnailSize(const QSize& size)
+{
+    if (m_thumbnailSize == size) return;
+    beginResetModel();
+    m_thumbnailSize = size;
+    m_requests.clear();
+    m_thumbnails.clear();
+    m_placeholder = QImage();
+    endResetModel();
+}
+
+QString PreviewThumbnailsModel::diskCachePath() const
+{
+    return m_diskCachePath;
+}
+
+void PreviewThumbnailsModel::setDiskCachePath(const QString& path)
+{
+    clearDiskCache();
+    m_diskCachePath = path;
+}
+
+void PreviewThumbnailsModel::invalidate(int pageIndex)
+{
+    if (pageIndex < 0 || pageIndex >= m_pages.count()) return;
+    m_thumbnails.remove(pageIndex);
+    if (!m_diskCachePath.isEmpty())
+        QFile::remove(diskCacheFileName(generationCachePath(), pageIndex));
+    QModelIndex changedIndex = index(pageIndex);
+    emit dataChanged(changedIndex, changedIndex);
+}
+
+int PreviewThumbnailsModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_pages.count();
+}
+
+QVariant PreviewThumbnailsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_pages.count()) return QVariant();
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString::number(index.row() + 1);
+    case Qt::DecorationRole:{
+        QImage* thumbnail = m_thumbnails.object(index.row());
+        if (thumbnail) return QPixmap::fromImage(*thumbnail);
+        // the view only asks for the rows it shows, so only visible pages are queued
+        requestThumbnail(index.row());
+        if (m_placeholder.isNull()){
+            PreviewThumbnailsModel* self = const_cast<PreviewThumbnailsModel*>(this);
+            self->m_placeholder = QImage(pageImageSize(m_pages.at(index.row()).data()), QImage::Format_ARGB32_Premultiplied);
+            self->m_placeholder.fill(Qt::white);
+        }
+        return QPixmap::fromImage(m_placeholder);
+    }
+    case Qt::SizeHintRole:
+        return QSize(m_thumbnailSize.width() + 8, m_thumbnailSize.height() + 24);
+    default:
+        return QVariant();
+    }
+}
+
+void PreviewThumbnailsModel::requestThumbnail(int pageIndex) const
+{
+    m_requests.removeAll(pageIndex);
+    m_requests.append(pageIndex);
+    if (!m_generationTimer.isActive())
+        m_generationTimer.start();
+}
+
+void PreviewThumbnailsModel::slotGenerateNext()
+{
+    for (int i = 0; i < THUMBNAILS_PER_TICK && !m_requests.isEmpty(); ++i){
+        // the most recently requested page is the one the user is looking at
+        int pageIndex = m_requests.takeLast();
+        if (pageIndex >= m_pages.count() || m_thumbnails.contains(pageIndex)) continue;
+
+        QImage thumbnail;
+        QString cacheFileName;
+        if (!m_diskCachePath.isEmpty()){
+            cacheFileName = diskCacheFileName(generationCachePath(), pageIndex);
+            if (QFile::exists(cacheFileName))
+                thumbnail.load(cacheFileName, "PNG");
+        }
+        if (thumbnail.isNull()){
+            PageItemDesignIntf* page = m_pages.at(pageIndex).data();
+            thumbnail = PageDesignIntf::renderPageToImage(page, pageImageSize(page));
+            if (!cacheFileName.isEmpty() && QDir().mkpath(generationCachePath()))
+                writeToDisk(cacheFileName, thumbnail);
+        }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+        m_thumbnails.insert(pageIndex, new QImage(thumbnail), int(thumbnail.sizeInBytes()));
+#else
+        m_thumbnails.insert(pageIndex, new QImage(thumbnail), thumbnail.byteCount());
+#endif
+        QModelIndex changedIndex = index(pageIndex);
+        emit dataChanged(changedIndex, changedIndex);
+    }
+    if (m_requests.isEmpty())
+        m_generationTimer.stop();
+}
+
+QSize PreviewThumbnailsModel::pageImageSize(PageItemDesignIntf* page) const
+{
+    QSizeF pageSize = page->rect().size();
+    pageSize.scale(m_thumbnailSize, Qt::KeepAspectRatio);
+    return pageSize.toSize();
+}
+
+QString PreviewThumbnailsModel::diskCacheFileName(const QString& path, int pageIndex) const
+{
+    return QString("%1/page_%2.png").arg(path).arg(pageIndex + 1);
+}
+
+// Thumbnails of each set of pages go to their own directory under the cache
+// path, so pages of another report or of a reloaded one never match them.
+QString PreviewThumbnailsModel::generationCachePath() const
+{
+    return QString("%1/%2").arg(m_diskCachePath).arg(m_generation);
+}
+
+void PreviewThumbnailsModel::clearDiskCache()
+{
+    m_diskWriters.waitForDone();
+    if (m_diskCachePath.isEmpty() || m_generation.isEmpty()) return;
+    QDir dir(generationCachePath());
+    if (!dir.exists()) return;
+    foreach (QString fileName, dir.entryList(QStringList() << "page_*.png", QDir::Files)) {
+        dir.remove(fileName);
+    }
+    QDir(m_diskCachePath).rmdir(m_generation);
+}
+
+void PreviewThumbnailsModel::writeToDisk(const QString& fileName, const QImage& image)
+{
+    m_diskWriters.start(new ThumbnailWriter(fileName, image));
+}
+
+} // namespace LimeReport
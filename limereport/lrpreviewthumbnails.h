@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   This file is part of the Lime Report project                          *
+ *   Copyright (C) 2015 by Alexander Arin                                  *
+ *   arin_a@bk.ru                                                          *
+ *                                                                         *
+ **                   GNU General Public License Usage                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ **                  GNU Lesser General Public License                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation, either version 3 of the    *
+ *   License, or (at your option) any later version.                       *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library.                                      *
+ *   If not, see <http://www.gnu.org/licenses/>.                           *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ****************************************************************************/
+#ifndef LRPREVIEWTHUMBNAILS_H
+#define LRPREVIEWTHUMBNAILS_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QImage>
+#include <QTimer>
+#include <QThreadPool>
+
+#include "lrpageitemdesignintf.h"
+
+namespace LimeReport {
+
+class PreviewThumbnailsModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit PreviewThumbnailsModel(QObject* parent = 0);
+    ~PreviewThumbnailsModel();
+    void setPages(ReportPages pages);
+    QSize thumbnailSize() const;
+    void setThumbnailSize(const QSize& size);
+    QString diskCachePath() const;
+    void setDiskCachePath(const QString& path);
+    void invalidate(int pageIndex);
+    // QAbstractItemModel interface
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role) const;
+private slots:
+    void slotGenerateNext();
+private:
+    QSize pageImageSize(PageItemDesignIntf* page) const;
+    QString diskCacheFileName(const QString& path, int pageIndex) const;
+    QString generationCachePath() const;
+    void clearDiskCache();
+    void requestThumbnail(int pageIndex) const;
+    void writeToDisk(const QString& fileName, const QImage& image);
+private:
+    ReportPages m_pages;
+    QSize m_thumbnailSize;
+    QString m_diskCachePath;
+    QString m_generation;
+    QImage m_placeholder;
+    mutable QCache<int, QImage> m_thumbnails;
+    mutable QList<int> m_requests;
+    mutable QTimer m_generationTimer;
+    QThreadPool m_diskWriters;
+};
+
+} // namespace LimeReport
+
+#endif // LRPREVIEWTHUMBNAILS_H
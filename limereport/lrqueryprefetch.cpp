@@ -0,0 +1,102 @@
+#include "lrqueryprefetch.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+
+namespace LimeReport{
+
+QueryResultModel::QueryResultModel(const QueryResult &result, QObject *parent)
+    : QAbstractTableModel(parent), m_result(result)
+{}
+
+int QueryResultModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_result.rows.count();
+}
+
+int QueryResultModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_result.fieldNames.count();
+}
+
+QVariant QueryResultModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+    const QVariantList& row = m_result.rows.at(index.row());
+    return index.column() < row.count() ? row.at(index.column()) : QVariant();
+}
+
+QVariant QueryResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole &&
+        section >= 0 && section < m_result.fieldNames.count())
+        return m_result.fieldNames.at(section);
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+QueryPrefetchTask::QueryPrefetchTask(const QString &connectionName, const QString &sql)
+    : m_port(-1), m_sql(sql), m_succeeded(false)
+{
+    setAutoDelete(false);
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    m_driverName = db.driverName();
+    m_databaseName = db.databaseName();
+    m_hostName = db.hostName();
+    m_userName = db.userName();
+    m_password = db.password();
+    m_port = db.port();
+    m_connectOptions = db.connectOptions();
+}
+
+void QueryPrefetchTask::bindValue(const QString &placeholder, const QVariant &value)
+{
+    m_boundValues.insert(placeholder, value);
+}
+
+void QueryPrefetchTask::run()
+{
+    QString cloneName = QString("limereport_prefetch_%1").arg(quintptr(this), 0, 16);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(m_driverName, cloneName);
+        db.setDatabaseName(m_databaseName);
+        db.setHostName(m_hostName);
+        db.setUserName(m_userName);
+        db.setPassword(m_password);
+        db.setPort(m_port);
+        db.setConnectOptions(m_connectOptions);
+        if (db.open()){
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            if (query.prepare(m_sql)){
+                QMap<QString, QVariant>::const_iterator it = m_boundValues.constBegin();
+                for (; it != m_boundValues.constEnd(); ++it)
+                    query.bindValue(it.key(), it.value());
+            }
+            if (query.exec()){
+                QSqlRecord record = query.record();
+                for (int i = 0; i < record.count(); ++i)
+                    m_result.fieldNames.append(record.fieldName(i));
+                while (query.next()){
+                    QVariantList row;
+                    row.reserve(record.count());
+                    for (int i = 0; i < record.count(); ++i)
+                        row.append(query.value(i));
+                    m_result.rows.append(row);
+                }
+                m_succeeded = !query.lastError().isValid();
+            }
+            if (!m_succeeded) m_lastError = query.lastError().text();
+            db.close();
+        } else {
+            m_lastError = db.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(cloneName);
+}
+
+} // namespace LimeReport
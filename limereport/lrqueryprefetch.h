@@ -0,0 +1,60 @@
+#ifndef LRQUERYPREFETCH_H
+#define LRQUERYPREFETCH_H
+
+#include <QAbstractTableModel>
+#include <QRunnable>
+#include <QStringList>
+#include <QVector>
+#include <QVariant>
+#include <QMap>
+
+namespace LimeReport{
+
+struct QueryResult{
+    QStringList fieldNames;
+    QVector<QVariantList> rows;
+};
+
+// Detached, fully fetched query result; it does not keep a database
+// connection or a QSqlQuery alive, so it can be produced on another thread.
+class QueryResultModel : public QAbstractTableModel{
+    Q_OBJECT
+public:
+    explicit QueryResultModel(const QueryResult& result, QObject* parent = 0);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+private:
+    QueryResult m_result;
+};
+
+// Executes one prepared statement on a private clone of a database connection.
+// All inputs are captured on the GUI thread by QueryHolder::createPrefetchTask().
+class QueryPrefetchTask : public QRunnable{
+public:
+    QueryPrefetchTask(const QString& connectionName, const QString& sql);
+    void bindValue(const QString& placeholder, const QVariant& value);
+    const QMap<QString, QVariant>& boundValues() const { return m_boundValues; }
+    void run();
+    bool isSucceeded() const { return m_succeeded; }
+    QString lastError() const { return m_lastError; }
+    const QueryResult& result() const { return m_result; }
+private:
+    QString m_driverName;
+    QString m_databaseName;
+    QString m_hostName;
+    QString m_userName;
+    QString m_password;
+    int m_port;
+    QString m_connectOptions;
+    QString m_sql;
+    QMap<QString, QVariant> m_boundValues;
+    QueryResult m_result;
+    bool m_succeeded;
+    QString m_lastError;
+};
+
+} // namespace LimeReport
+
+#endif // LRQUERYPREFETCH_H
@@ -0,0 +1,91 @@
+#include "lrqueryresultcache.h"
+
+#include <QDateTime>
+#include <QStringList>
+
+namespace LimeReport{
+
+QueryResultCache::QueryResultCache()
+    : m_timeToLive(0)
+{
+    m_cache.setMaxCost(0);
+}
+
+void QueryResultCache::setMaxCells(int value)
+{
+    m_cache.setMaxCost(qMax(value, 0));
+}
+
+bool QueryResultCache::find(const QString &key, QueryResult &result)
+{
+    Entry* entry = m_cache.object(key);
+    if (!entry) return false;
+    if (m_timeToLive > 0 &&
+        QDateTime::currentMSecsSinceEpoch() - entry->created > qint64(m_timeToLive) * 1000){
+        m_cache.remove(key);
+        return false;
+    }
+    result = entry->result;
+    return true;
+}
+
+void QueryResultCache::insert(const QString &key, const QString &connectionName, const QueryResult &result)
+{
+    if (!isEnabled()) return;
+    int cost = qMax(result.rows.count() * result.fieldNames.count(), 1);
+    if (cost > m_cache.maxCost()) return;
+    Entry* entry = new Entry;
+    entry->connectionName = connectionName;
+    entry->result = result;
+    entry->created = QDateTime::currentMSecsSinceEpoch();
+    m_cache.insert(key, entry, cost);
+}
+
+void QueryResultCache::clear(const QString &connectionName)
+{
+    if (connectionName.isEmpty()){
+        m_cache.clear();
+        return;
+    }
+    foreach(QString key, m_cache.keys()){
+        Entry* entry = m_cache.object(key);
+        if (entry && entry->connectionName.compare(connectionName, Qt::CaseInsensitive) == 0)
+            m_cache.remove(key);
+    }
+}
+
+QString QueryResultCache::key(const QString &connectionName, const QString &sql, const QMap<QString, QVariant> &boundValues)
+{
+    QStringList parts;
+    parts << connectionName.toLower() << sql;
+    QMap<QString, QVariant>::const_iterator it = boundValues.constBegin();
+    for (; it != boundValues.constEnd(); ++it){
+        if (it.value().isNull())
+            parts << QString("%1=%2!").arg(it.key()).arg(it.value().userType());
+        else
+            parts << QString("%1=%2:%3").arg(it.key()).arg(it.value().userType()).arg(keyText(it.value()));
+    }
+    return parts.join(QChar(0x1f));
+}
+
+// Text that tells apart every value the database could see as different;
+// toString() drops milliseconds and the time spec of dates and rounds doubles.
+QString QueryResultCache::keyText(const QVariant &value)
+{
+    switch (value.type()) {
+    case QVariant::DateTime:{
+        QDateTime dateTime = value.toDateTime();
+        return QString("%1 %2").arg(dateTime.toMSecsSinceEpoch()).arg(int(dateTime.timeSpec()));
+    }
+    case QVariant::Time:
+        return QString::number(QTime(0,0).msecsTo(value.toTime()));
+    case QVariant::Double:
+        return QString::number(value.toDouble(), 'g', 17);
+    case QVariant::ByteArray:
+        return QString::fromLatin1(value.toByteArray().toBase64());
+    default:
+        return value.toString();
+    }
+}
+
+} // namespace LimeReport
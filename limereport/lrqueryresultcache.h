@@ -0,0 +1,40 @@
+#ifndef LRQUERYRESULTCACHE_H
+#define LRQUERYRESULTCACHE_H
+
+#include <QCache>
+#include <QMap>
+#include <QString>
+#include <QVariant>
+#include "lrqueryprefetch.h"
+
+namespace LimeReport{
+
+// Session cache of fetched query rowsets keyed by connection, prepared SQL
+// and bound parameter values. The size is bounded by the total number of
+// cached cells; a limit of 0 disables the cache.
+class QueryResultCache{
+public:
+    QueryResultCache();
+    bool isEnabled() const { return m_cache.maxCost() > 0; }
+    int  maxCells() const { return m_cache.maxCost(); }
+    void setMaxCells(int value);
+    int  timeToLive() const { return m_timeToLive; }
+    void setTimeToLive(int seconds){ m_timeToLive = seconds; }
+    bool find(const QString& key, QueryResult& result);
+    void insert(const QString& key, const QString& connectionName, const QueryResult& result);
+    void clear(const QString& connectionName = QString());
+    static QString key(const QString& connectionName, const QString& sql, const QMap<QString, QVariant>& boundValues);
+private:
+    static QString keyText(const QVariant& value);
+    struct Entry{
+        QString connectionName;
+        QueryResult result;
+        qint64 created;
+    };
+    QCache<QString, Entry> m_cache;
+    int m_timeToLive;
+};
+
+} // namespace LimeReport
+
+#endif // LRQUERYRESULTCACHE_H
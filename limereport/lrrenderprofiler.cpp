@@ -0,0 +1,115 @@
+#include "lrrenderprofiler.h"
+
+#include <QList>
+#include <QPair>
+#include <QStringList>
+#include <algorithm>
+
+namespace LimeReport{
+
+namespace {
+
+const char* categoryName(RenderProfiler::Category category)
+{
+    switch (category) {
+    case RenderProfiler::Band:       return "bands";
+    case RenderProfiler::ItemType:   return "itemTypes";
+    case RenderProfiler::DataSource: return "datasources";
+    case RenderProfiler::Script:     return "scripts";
+    case RenderProfiler::Page:       return "pages";
+    default:                         return "";
+    }
+}
+
+QString jsonString(const QString& value)
+{
+    QString result;
+    result.reserve(value.length() + 2);
+    result += '"';
+    foreach(QChar c, value){
+        switch (c.unicode()) {
+        case '"':  result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (c.unicode() < 0x20)
+                result += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+            else
+                result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+QString msecs(qint64 nsecs)
+{
+    return QString::number(nsecs / 1000000.0, 'f', 3);
+}
+
+bool totalGreaterThan(const QPair<qint64, QString>& e1, const QPair<qint64, QString>& e2)
+{
+    return e1.first > e2.first;
+}
+
+} // namespace
+
+RenderProfiler::RenderProfiler()
+    : m_enabled(false), m_total(0)
+{}
+
+void RenderProfiler::start()
+{
+    for (int i = 0; i < CategoryCount; ++i)
+        m_entries[i].clear();
+    m_total = 0;
+    if (m_enabled) m_timer.start();
+}
+
+void RenderProfiler::finish()
+{
+    if (m_enabled && m_timer.isValid())
+        m_total = m_timer.nsecsElapsed();
+}
+
+void RenderProfiler::addSample(Category category, const QString &name, qint64 nsecs)
+{
+    Entry& entry = m_entries[category][name];
+    entry.count++;
+    entry.total += nsecs;
+    entry.max = qMax(entry.max, nsecs);
+}
+
+QString RenderProfiler::categoryToJson(Category category) const
+{
+    // slowest first
+    QList< QPair<qint64, QString> > order;
+    QHash<QString, Entry>::const_iterator it = m_entries[category].constBegin();
+    for (; it != m_entries[category].constEnd(); ++it)
+        order.append(qMakePair(it.value().total, it.key()));
+    std::stable_sort(order.begin(), order.end(), totalGreaterThan);
+
+    QStringList items;
+    for (int i = 0; i < order.count(); ++i){
+        const Entry& entry = m_entries[category][order.at(i).second];
+        items.append(QString("{\"name\":%1,\"count\":%2,\"totalMs\":%3,\"maxMs\":%4}")
+                     .arg(jsonString(order.at(i).second))
+                     .arg(entry.count)
+                     .arg(msecs(entry.total))
+                     .arg(msecs(entry.max)));
+    }
+    return QString("\"%1\":[%2]").arg(categoryName(category)).arg(items.join(","));
+}
+
+QString RenderProfiler::toJson() const
+{
+    QStringList parts;
+    parts.append(QString("\"totalMs\":%1").arg(msecs(m_total)));
+    for (int i = 0; i < CategoryCount; ++i)
+        parts.append(categoryToJson(Category(i)));
+    return "{" + parts.join(",") + "}";
+}
+
+} // namespace LimeReport
@@ -0,0 +1,74 @@
+#ifndef LRRENDERPROFILER_H
+#define LRRENDERPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+
+namespace LimeReport{
+
+// Accumulates render timings by pattern band, item type, datasource,
+// script and printed page. Disabled by default; a disabled profiler costs
+// one pointer test per measured scope.
+class RenderProfiler{
+public:
+    enum Category{Band, ItemType, DataSource, Script, Page, CategoryCount};
+    RenderProfiler();
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool value){ m_enabled = value; }
+    void start();
+    void finish();
+    void addSample(Category category, const QString& name, qint64 nsecs);
+    QString toJson() const;
+private:
+    struct Entry{
+        Entry():count(0), total(0), max(0){}
+        qint64 count;
+        qint64 total;
+        qint64 max;
+    };
+    QString categoryToJson(Category category) const;
+private:
+    bool m_enabled;
+    QHash<QString, Entry> m_entries[CategoryCount];
+    QElapsedTimer m_timer;
+    qint64 m_total;
+};
+
+// Names are composed only when the profiler is enabled, so callers pass the
+// raw pieces: maxLength >= 0 trims the name and cuts it to that length.
+class RenderProfileScope{
+public:
+    RenderProfileScope(RenderProfiler* profiler, RenderProfiler::Category category, const QString& name,
+                       int maxLength = -1)
+        : m_profiler(profiler && profiler->isEnabled() ? profiler : 0), m_category(category)
+    {
+        if (m_profiler){
+            m_name = maxLength < 0 ? name : name.trimmed().left(maxLength);
+            m_timer.start();
+        }
+    }
+    RenderProfileScope(RenderProfiler* profiler, RenderProfiler::Category category,
+                       const char* prefix, const QString& name, const char* suffix)
+        : m_profiler(profiler && profiler->isEnabled() ? profiler : 0), m_category(category)
+    {
+        if (m_profiler){
+            m_name = QString::fromLatin1(prefix) + name + QString::fromLatin1(suffix);
+            m_timer.start();
+        }
+    }
+    ~RenderProfileScope()
+    {
+        if (m_profiler) m_profiler->addSample(m_category, m_name, m_timer.nsecsElapsed());
+    }
+private:
+    Q_DISABLE_COPY(RenderProfileScope)
+    RenderProfiler* m_profiler;
+    RenderProfiler::Category m_category;
+    QString m_name;
+    QElapsedTimer m_timer;
+};
+
+} // namespace LimeReport
+
+#endif // LRRENDERPROFILER_H
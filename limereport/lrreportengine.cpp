@@ -37,6 +37,8 @@
 #include <QPluginLoader>
 #include <QFileDialog>
 #include <QGraphicsScene>
+#include <QMetaProperty>
+#include <QThread>
 
 #include "time.h"
 
@@ -67,6 +69,7 @@
 # define EASY_END_BLOCK
 #endif
 #include "lrpreparedpages.h"
+#include "lrtemplatecache.h"
 
 #ifdef HAVE_STATIC_BUILD
 #include "lrfactoryinitializer.h"
@@ -78,16 +81,16 @@ QSettings* ReportEngine::m_settings = 0;
 
 ReportEnginePrivate::ReportEnginePrivate(QObject *parent) :
     QObject(parent), m_preparedPagesManager(new PreparedPages(&m_preparedPages)), m_fileName(""), m_settings(0), m_ownedSettings(false),
-    m_printer(new QPrinter(QPrinter::HighResolution)), m_printerSelected(false),
+    m_printerSelected(false),
     m_showProgressDialog(true), m_reportName(""), m_activePreview(0),
     m_previewWindowIcon(":/report/images/logo32"), m_previewWindowTitle(tr("Preview")),
     m_reportRendering(false), m_resultIsEditable(true), m_passPhrase("HjccbzHjlbyfCkjy"),
     m_fileWatcher( new QFileSystemWatcher( this ) ), m_reportLanguage(QLocale::AnyLanguage),
-    m_previewLayoutDirection(Qt::LayoutDirectionAuto), m_designerFactory(0),
+    m_previewLayoutDirection(Qt::LayoutDirectionAuto), m_designerFactory(0), m_designerPluginsLoaded(false),
     m_previewScaleType(FitWidth), m_previewScalePercent(0), m_startTOCPage(0),
     m_previewPageBackgroundColor(Qt::gray),
     m_saveToFileVisible(true), m_printToPdfVisible(true),
-    m_printVisible(true)
+    m_printVisible(true), m_skipDefaultValuesOnSave(false)
 {
 #ifdef HAVE_STATIC_BUILD
     initResources();
@@ -109,26 +112,6 @@ ReportEnginePrivate::ReportEnginePrivate(QObject *parent) :
     m_datasources->setObjectName("datasources");
     connect(m_datasources,SIGNAL(loadCollectionFinished(QString)),this,SLOT(slotDataSourceCollectionLoaded(QString)));
     connect(m_fileWatcher,SIGNAL(fileChanged(const QString &)),this,SLOT(slotLoadFromFile(const QString &)));
-
-    QDir pluginsDir = QCoreApplication::applicationDirPath();
-    pluginsDir.cd("../lib" );
-    if (!pluginsDir.exists()){
-        pluginsDir.cd("./lib");
-        if (!pluginsDir.exists()) pluginsDir.setPath(QCoreApplication::applicationDirPath());
-    }
-
-    foreach( const QString& pluginName, pluginsDir.entryList( QDir::Files ) ) {
-        QPluginLoader loader( pluginsDir.absoluteFilePath( pluginName ) );
-        if( loader.load() ) {
-#ifndef HAVE_REPORT_DESIGNER
-            if( LimeReportDesignerPluginInterface* designerPlugin = qobject_cast< LimeReportDesignerPluginInterface* >( loader.instance() ) ) {
-                m_designerFactory = designerPlugin;
-                break;
-            }
-#endif
-        }        
-    }
-
 }
 
 ReportEnginePrivate::~ReportEnginePrivate()
@@ -218,7 +201,10 @@ void ReportEnginePrivate::saveError(QString message)
 
 void ReportEnginePrivate::showError(QString message)
 {
-    QMessageBox::critical(0,tr("Error"),message);
+    if (isInteractiveSession())
+        QMessageBox::critical(0,tr("Error"),message);
+    else
+        qWarning() << message;
 }
 
 void ReportEnginePrivate::updateTranslations()
@@ -270,21 +256,29 @@ bool ReportEnginePrivate::printPages(ReportPages pages, QPrinter *printer)
         QPrinterInfo pi;
         if (!pi.defaultPrinter().isNull())
 #ifdef HAVE_QT4
-            m_printer.data()->setPrinterName(pi.defaultPrinter().printerName());
+            defaultPrinter()->setPrinterName(pi.defaultPrinter().printerName());
 #endif
 #ifdef HAVE_QT5
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 3, 0))
-        m_printer.data()->setPrinterName(pi.defaultPrinterName());
+        defaultPrinter()->setPrinterName(pi.defaultPrinterName());
 #else
-        m_printer.data()->setPrinterName(pi.defaultPrinter().printerName());
+        defaultPrinter()->setPrinterName(pi.defaultPrinter().printerName());
 #endif
 #endif
-        QPrintDialog dialog(m_printer.data(),QApplication::activeWindow());
-        m_printerSelected = dialog.exec()!=QDialog::Rejected;
+        if (isInteractiveSession()){
+            QPrintDialog dialog(defaultPrinter(),QApplication::activeWindow());
+            m_printerSelected = dialog.exec()!=QDialog::Rejected;
+        } else {
+            // never print to whatever the default printer happens to be without asking
+            QString message = tr("Printer is not selected! A printer must be passed to print in a non-interactive session");
+            saveError(message);
+            showError(message);
+            return false;
+        }
     }
     if (!printer&&!m_printerSelected) return false;
 
-    printer =(printer)?printer:m_printer.data();
+    printer =(printer)?printer:defaultPrinter();
     if (printer&&printer->isValid()){
         try{
             if (pages.count()>0){
@@ -321,13 +315,17 @@ void ReportEnginePrivate::internalPrintPages(ReportPages pages, QPrinter &printe
                 ))
            )
         {
-              printProcessors["default"]->printPage(page);
+              {
+                  RenderProfileScope profileScope(dataManager()->renderProfiler(), RenderProfiler::Page, page->patternName());
+                  printProcessors["default"]->printPage(page);
+              }
               emit pagePrintingFinished(currenPage);
               QApplication::processEvents();
         }
 
         currenPage++;
     }
+    dataManager()->renderProfiler()->finish();
     emit printingFinished();
 }
 
@@ -392,21 +390,29 @@ bool ReportEnginePrivate::printReport(QPrinter* printer)
         QPrinterInfo pi;
         if (!pi.defaultPrinter().isNull())
 #ifdef HAVE_QT4
-            m_printer.data()->setPrinterName(pi.defaultPrinter().printerName());
+            defaultPrinter()->setPrinterName(pi.defaultPrinter().printerName());
 #endif
 #ifdef HAVE_QT5
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 3, 0))
-            m_printer.data()->setPrinterName(pi.defaultPrinterName());
+            defaultPrinter()->setPrinterName(pi.defaultPrinterName());
 #else
-        m_printer.data()->setPrinterName(pi.defaultPrinter().printerName());
+        defaultPrinter()->setPrinterName(pi.defaultPrinter().printerName());
 #endif
 #endif
-        QPrintDialog dialog(m_printer.data(),QApplication::activeWindow());
-        m_printerSelected = dialog.exec()!=QDialog::Rejected;
+        if (isInteractiveSession()){
+            QPrintDialog dialog(defaultPrinter(),QApplication::activeWindow());
+            m_printerSelected = dialog.exec()!=QDialog::Rejected;
+        } else {
+            // never print to whatever the default printer happens to be without asking
+            QString message = tr("Printer is not selected! A printer must be passed to print in a non-interactive session");
+            saveError(message);
+            showError(message);
+            return false;
+        }
     }
     if (!printer&&!m_printerSelected) return false;
 
-    printer =(printer)?printer:m_printer.data();
+    printer =(printer)?printer:defaultPrinter();
     if (printer&&printer->isValid()){
         try{
             bool designTime = dataManager()->designTime();
@@ -468,10 +474,10 @@ bool ReportEnginePrivate::exportReport(QString exporterName, const QString &file
     QString fn = fileName;
     if (ExportersFactory::instance().map().contains(exporterName)){
         ReportExporterInterface* e = ExportersFactory::instance().objectCreator(exporterName)(this);
-        if (fn.isEmpty()){
+        if (fn.isEmpty() && isInteractiveSession()){
             QString defaultFileName = reportName().split(".")[0];
             QString filter = QString("%1 (*.%2)").arg(e->exporterName()).arg(e->exporterFileExt());
-            QString fn = QFileDialog::getSaveFileName(0, tr("%1 file name").arg(e->exporterName()), defaultFileName, filter);
+            fn = QFileDialog::getSaveFileName(0, tr("%1 file name").arg(e->exporterName()), defaultFileName, filter);
         }
         if (!fn.isEmpty()){
             QFileInfo fi(fn);
@@ -558,7 +564,7 @@ void ReportEnginePrivate::previewReport(QPrinter* printer, PreviewHints hints)
 ReportDesignWindowInterface*ReportEnginePrivate::getDesignerWindow()
 {
     if (!m_designerWindow) {
-        if (m_designerFactory){
+        if (designerFactory()){
             m_designerWindow = m_designerFactory->getDesignerWindow(this,QApplication::activeWindow(),settings());
             m_designerWindow->setAttribute(Qt::WA_DeleteOnClose,true);
             m_designerWindow->setWindowIcon(QIcon(":report/images/logo32"));
@@ -645,6 +651,11 @@ void ReportEnginePrivate::emitPrintedToPDF(QString fileName)
     emit printedToPDF(fileName);
 }
 
+void ReportEnginePrivate::emitExportedToImage(QStringList fileNames)
+{
+    emit exportedToImage(fileNames);
+}
+
 bool ReportEnginePrivate::isSaved()
 {
     foreach (PageDesignIntf* page, m_pages) {
@@ -690,19 +701,7 @@ bool ReportEnginePrivate::slotLoadFromFile(const QString &fileName)
             m_fileName=fileName;
             QFileInfo fi(fileName);
             m_reportName = fi.fileName();
-
-            QString dbSettingFileName = fi.absolutePath()+"/"+fi.baseName()+".db";
-            if (QFile::exists(dbSettingFileName)){
-                QSettings dbcredentals(dbSettingFileName, QSettings::IniFormat);
-                foreach (ConnectionDesc* connection, dataManager()->conections()) {
-                    if (!connection->keepDBCredentials()){
-                        dbcredentals.beginGroup(connection->name());
-                        connection->setUserName(dbcredentals.value("user").toString());
-                        connection->setPassword(dbcredentals.value("password").toString());
-                        dbcredentals.endGroup();
-                    }
-                }
-            }
+            loadDBCredentials(fi);
             EASY_BLOCK("Connect auto connections")
             dataManager()->connectAutoConnections();
             EASY_END_BLOCK;
@@ -721,6 +720,143 @@ bool ReportEnginePrivate::slotLoadFromFile(const QString &fileName)
     return false;
 }
 
+void ReportEnginePrivate::loadDBCredentials(const QFileInfo& fileInfo)
+{
+    QString dbSettingFileName = fileInfo.absolutePath()+"/"+fileInfo.baseName()+".db";
+    if (QFile::exists(dbSettingFileName)){
+        QSettings dbcredentals(dbSettingFileName, QSettings::IniFormat);
+        foreach (ConnectionDesc* connection, dataManager()->conections()) {
+            if (!connection->keepDBCredentials()){
+                dbcredentals.beginGroup(connection->name());
+                connection->setUserName(dbcredentals.value("user").toString());
+                connection->setPassword(dbcredentals.value("password").toString());
+                dbcredentals.endGroup();
+            }
+        }
+    }
+}
+
+static void resetPatternItems(BaseDesignIntf* item)
+{
+    item->setPatternName("");
+    item->setPatternItem(0);
+    foreach(BaseDesignIntf* child, item->childBaseItems())
+        resetPatternItems(child);
+}
+
+// Page prototypes are QObjects, so they are built and cloned only in the
+// application thread; engines living in other threads read the cached document.
+static bool isPagePrototypesThread()
+{
+    return QCoreApplication::instance() &&
+           QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+static void deletePagePrototype(PageItemDesignIntf* prototype)
+{
+    // the last reference to a template can be dropped in any thread
+    if (prototype) prototype->deleteLater();
+}
+
+static CachedPage cachePage(PageDesignIntf* page)
+{
+    CachedPage result;
+    result.name = page->objectName();
+    // only the report level properties, the scene ones follow the page item
+    const QMetaObject* metaObject = page->metaObject();
+    for (int i = PageDesignIntf::staticMetaObject.propertyOffset(); i < metaObject->propertyCount(); ++i){
+        QMetaProperty property = metaObject->property(i);
+        if (property.isWritable())
+            result.properties.insert(property.name(), property.read(page));
+    }
+    result.prototype = PageItemDesignIntf::Ptr(
+        dynamic_cast<PageItemDesignIntf*>(page->pageItem()->cloneItem(page->pageItem()->itemMode())),
+        deletePagePrototype
+    );
+    result.prototype->setReportSettings(0);
+    resetPatternItems(result.prototype.data());
+    return result;
+}
+
+PageDesignIntf* ReportEnginePrivate::createCachedPage(const CachedPage& cachedPage)
+{
+    PageDesignIntf* page = createPage(cachedPage.name);
+    foreach(QString name, cachedPage.properties.keys())
+        page->setProperty(name.toLatin1(), cachedPage.properties.value(name));
+    PageItemDesignIntf::Ptr pageItem(
+        dynamic_cast<PageItemDesignIntf*>(cachedPage.prototype->cloneItem(cachedPage.prototype->itemMode()))
+    );
+    resetPatternItems(pageItem.data());
+    page->setPageItem(pageItem);
+    page->setReportSettings(&m_reportSettings);
+    ICollectionContainer* co = dynamic_cast<ICollectionContainer*>(pageItem.data());
+    if (co) co->collectionLoadFinished("children");
+    return page;
+}
+
+bool ReportEnginePrivate::loadFromTemplateCache(const QString &fileName, bool autoLoadPreviewOnChange)
+{
+    if ( !m_fileWatcher->files().isEmpty() )
+        m_fileWatcher->removePaths( m_fileWatcher->files() );
+    if ( autoLoadPreviewOnChange )
+        m_fileWatcher->addPath( fileName );
+
+    PreviewReportWindow  *currentPreview = qobject_cast<PreviewReportWindow *>(m_activePreview);
+
+    CachedTemplate::Ptr cachedTemplate = TemplateCache::instance().acquire(fileName, &m_lastError);
+    if (!cachedTemplate){
+        if (!QFile::exists(fileName) && hasActivePreview()){
+            QMessageBox::information( NULL,
+                                      tr( "Report File Change" ),
+                                      tr( "The report file \"%1\" has changed names or been deleted.\n\nThis preview is no longer valid." ).arg( fileName )
+                                      );
+            clearReport();
+            currentPreview->close();
+        }
+        return false;
+    }
+
+    clearReport();
+
+    // in the application thread the first load reads the whole document and keeps
+    // copies of the built pages, later loads read the rest of the report and clone
+    // the cached pages; other threads always build the pages from the document
+    bool usePrototypes = isPagePrototypesThread();
+    QMutexLocker locker(&cachedTemplate->readLock);
+    bool clonePages = usePrototypes && cachedTemplate->pagesBuilt;
+    ItemsReaderIntf::Ptr reader(new XMLReader(
+        clonePages ? cachedTemplate->skeleton : cachedTemplate->document
+    ));
+    reader->setPassPhrase(m_passPhrase);
+    if (!reader->first() || !reader->readItem(this)){
+        m_lastError = reader->lastError();
+        return false;
+    }
+    if (clonePages){
+        foreach(CachedPage cachedPage, cachedTemplate->pages)
+            m_pages.append(createCachedPage(cachedPage));
+        collectionLoadFinished("pages");
+    } else if (usePrototypes){
+        foreach(PageDesignIntf* page, m_pages)
+            cachedTemplate->pages.append(cachePage(page));
+        cachedTemplate->pagesBuilt = true;
+    }
+    locker.unlock();
+
+    m_fileName = fileName;
+    QFileInfo fi(fileName);
+    m_reportName = fi.fileName();
+    loadDBCredentials(fi);
+    dataManager()->connectAutoConnections();
+    dropChanges();
+    if ( hasActivePreview() )
+    {
+       currentPreview->reloadPreview();
+    }
+    emit loadFinished();
+    return true;
+}
+
 void ReportEnginePrivate::cancelRender()
 {
     if (m_reportRender)
@@ -857,6 +993,7 @@ bool ReportEnginePrivate::saveToFile(const QString &fileName)
 
     QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
     writer->setPassPhrase(m_passPhrase);
+    writer->setSkipDefaultValues(m_skipDefaultValuesOnSave);
     writer->putItem(this);
     m_fileName=fn;   
     bool saved = writer->saveToFile(fn);
@@ -883,6 +1020,7 @@ QByteArray ReportEnginePrivate::saveToByteArray()
 {
     QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
     writer->setPassPhrase(m_passPhrase);
+    writer->setSkipDefaultValues(m_skipDefaultValuesOnSave);
     writer->putItem(this);
     QByteArray result = writer->saveToByteArray();
     if (!result.isEmpty()){
@@ -897,6 +1035,7 @@ QByteArray ReportEnginePrivate::saveToByteArray()
 QString ReportEnginePrivate::saveToString(){
     QScopedPointer< ItemsWriterIntf > writer(new XMLWriter());
     writer->setPassPhrase(m_passPhrase);
+    writer->setSkipDefaultValues(m_skipDefaultValuesOnSave);
     writer->putItem(this);
     QString result = writer->saveToString();
     if (!result.isEmpty()){
@@ -1135,6 +1274,16 @@ void ReportEnginePrivate::setResultEditable(bool value)
     m_resultIsEditable = value;
 }
 
+bool ReportEnginePrivate::skipDefaultValuesOnSave() const
+{
+    return m_skipDefaultValuesOnSave;
+}
+
+void ReportEnginePrivate::setSkipDefaultValuesOnSave(bool value)
+{
+    m_skipDefaultValuesOnSave = value;
+}
+
 bool ReportEnginePrivate::saveToFileIsVisible() const
 {
     return m_saveToFileVisible;
@@ -1260,12 +1409,58 @@ void ReportEnginePrivate::clearRenderingPages(){
     m_renderingPages.clear();
 }
 
+QPrinter* ReportEnginePrivate::defaultPrinter()
+{
+    // created on first use: export-only engines never touch the print system
+    if (!m_printer)
+        m_printer.reset(new QPrinter(QPrinter::HighResolution));
+    return m_printer.data();
+}
+
+LimeReportDesignerPluginInterface* ReportEnginePrivate::designerFactory()
+{
+    if (m_designerPluginsLoaded) return m_designerFactory;
+    m_designerPluginsLoaded = true;
+
+    QDir pluginsDir = QCoreApplication::applicationDirPath();
+    pluginsDir.cd("../lib" );
+    if (!pluginsDir.exists()){
+        pluginsDir.cd("./lib");
+        if (!pluginsDir.exists()) pluginsDir.setPath(QCoreApplication::applicationDirPath());
+    }
+
+    foreach( const QString& pluginName, pluginsDir.entryList( QDir::Files ) ) {
+        QPluginLoader loader( pluginsDir.absoluteFilePath( pluginName ) );
+        if( loader.load() ) {
+#ifndef HAVE_REPORT_DESIGNER
+            if( LimeReportDesignerPluginInterface* designerPlugin = qobject_cast< LimeReportDesignerPluginInterface* >( loader.instance() ) ) {
+                m_designerFactory = designerPlugin;
+                break;
+            }
+#endif
+        }
+    }
+    return m_designerFactory;
+}
+
+// Prepared statements keep cursors open on the server; they are released
+// however the render ends, including a failed init script or an exception.
+class PreparedQueriesReleaser{
+public:
+    explicit PreparedQueriesReleaser(DataSourceManager* dataManager): m_dataManager(dataManager){}
+    ~PreparedQueriesReleaser(){ m_dataManager->releasePreparedQueries(); }
+private:
+    DataSourceManager* m_dataManager;
+};
+
 ReportPages ReportEnginePrivate::renderToPages()
 {
     int startTOCPage = -1;
     int pageAfterTOCIndex = -1;
 
     if (m_reportRendering) return ReportPages();
+    PreparedQueriesReleaser preparedQueriesReleaser(dataManager());
+    dataManager()->renderProfiler()->start();
     initReport();
     m_reportRender = ReportRender::Ptr(new ReportRender);
     updateTranslations();
@@ -1308,8 +1503,10 @@ ReportPages ReportEnginePrivate::renderToPages()
         if (m_scriptEngineContext->runInitScript()){
 
             dataManager()->clearErrors();
-            dataManager()->connectAllDatabases();
+            dataManager()->connectAllDatabases(true);
             dataManager()->setDesignTime(false);
+            if (dataManager()->isQueryPrefetchEnabled())
+                dataManager()->prefetchQueries();
             dataManager()->updateDatasourceModel();
 
             activateLanguage(m_reportLanguage);
@@ -1352,6 +1549,7 @@ ReportPages ReportEnginePrivate::renderToPages()
             }
 
             m_reportRender->secondRenderPass(result);
+            dataManager()->renderProfiler()->finish();
 
             emit renderFinished();
             m_reportRender.clear();
@@ -1395,6 +1593,7 @@ ReportEngine::ReportEngine(QObject *parent)
     connect(d, SIGNAL(loadFinished()), this, SIGNAL(loadFinished()));
     connect(d, SIGNAL(cleared()), this, SIGNAL(cleared()));
     connect(d, SIGNAL(printedToPDF(QString)), this, SIGNAL(printedToPDF(QString)));
+    connect(d, SIGNAL(exportedToImage(QStringList)), this, SIGNAL(exportedToImage(QStringList)));
     
     connect(d, SIGNAL(getAvailableDesignerLanguages(QList<QLocale::Language>*)),
             this, SIGNAL(getAvailableDesignerLanguages(QList<QLocale::Language>*)));
@@ -1515,6 +1714,34 @@ bool ReportEngine::resultIsEditable()
     return d->resultIsEditable();
 }
 
+bool ReportEngine::loadFromTemplateCache(const QString &fileName, bool autoLoadPreviewOnChange)
+{
+    Q_D(ReportEngine);
+    return d->loadFromTemplateCache(fileName, autoLoadPreviewOnChange);
+}
+
+TemplateCacheStatistics ReportEngine::templateCacheStatistics()
+{
+    return TemplateCache::instance().statistics();
+}
+
+void ReportEngine::clearTemplateCache()
+{
+    TemplateCache::instance().clear();
+}
+
+void ReportEngine::setSkipDefaultValuesOnSave(bool value)
+{
+    Q_D(ReportEngine);
+    d->setSkipDefaultValuesOnSave(value);
+}
+
+bool ReportEngine::skipDefaultValuesOnSave()
+{
+    Q_D(ReportEngine);
+    return d->skipDefaultValuesOnSave();
+}
+
 void ReportEngine::setSaveToFileVisible(bool value)
 {
     Q_D(ReportEngine);
@@ -1781,6 +2008,24 @@ void ReportEngine::setShowDesignerModal(bool showDesignerModal)
     m_showDesignerModal = showDesignerModal;
 }
 
+void ReportEngine::setRenderProfilingEnabled(bool value)
+{
+    Q_D(ReportEngine);
+    d->dataManager()->renderProfiler()->setEnabled(value);
+}
+
+bool ReportEngine::isRenderProfilingEnabled()
+{
+    Q_D(ReportEngine);
+    return d->dataManager()->renderProfiler()->isEnabled();
+}
+
+QString ReportEngine::renderProfile()
+{
+    Q_D(ReportEngine);
+    return d->dataManager()->renderProfiler()->toJson();
+}
+
 ScriptEngineManager*LimeReport::ReportEnginePrivate::scriptManager(){
     ScriptEngineManager::instance().setContext(scriptContext());
     ScriptEngineManager::instance().setDataManager(dataManager());
@@ -1795,6 +2040,7 @@ PrintProcessor::PrintProcessor(QPrinter* printer)
 bool PrintProcessor::printPage(PageItemDesignIntf::Ptr page)
 {
     if (!m_firstPage && !m_painter->isActive()) return false;
+    PageContentGuard contentGuard(page.data());
     PageDesignIntf* backupPage = dynamic_cast<PageDesignIntf*>(page->scene());
 
     //LimeReport::PageDesignIntf m_renderPage;
@@ -124,6 +124,15 @@ private:
     QColor m_color;
 };
 
+class LIMEREPORT_EXPORT TemplateCacheStatistics{
+public:
+    TemplateCacheStatistics(): hits(0), misses(0), reloads(0), size(0){}
+    int hits;
+    int misses;
+    int reloads;
+    int size;
+};
+
 class ItemBuilder{
     virtual void setProperty(QString name, QVariant value) = 0;
     virtual QVariant property(QString name) = 0;
@@ -170,6 +179,9 @@ public:
     bool    loadFromFile(const QString& fileName, bool autoLoadPreviewOnChange = false);
     bool    loadFromByteArray(QByteArray *data);
     bool    loadFromString(const QString& data);
+    bool    loadFromTemplateCache(const QString& fileName, bool autoLoadPreviewOnChange = false);
+    static TemplateCacheStatistics templateCacheStatistics();
+    static void clearTemplateCache();
     QString reportFileName();
     void    setReportFileName(const QString& fileName);
     bool    saveToFile(const QString& fileName);
@@ -185,6 +197,8 @@ public:
     void setPreviewPageBackgroundColor(QColor color);
     void setResultEditable(bool value);
     bool resultIsEditable();
+    void setSkipDefaultValuesOnSave(bool value);
+    bool skipDefaultValuesOnSave();
     void setSaveToFileVisible(bool value);
     bool saveToFileIsVisible();
     void setPrintToPdfVisible(bool value);
@@ -210,6 +224,9 @@ public:
     bool printPreparedPages();
     bool showDesignerModal() const;
     void setShowDesignerModal(bool showDesignerModal);
+    void setRenderProfilingEnabled(bool value);
+    bool isRenderProfilingEnabled();
+    QString renderProfile();
 
 signals:
     void cleared();
@@ -228,6 +245,8 @@ signals:
     void saveFinished();
     void loadFinished();
     void printedToPDF(QString fileName);
+    // files written by the IMAGE exporter, one per page or a single TIFF
+    void exportedToImage(QStringList fileNames);
 
     void getAvailableDesignerLanguages(QList<QLocale::Language>* languages);
     void currentDefaultDesignerLanguageChanged(QLocale::Language);
@@ -47,6 +47,7 @@
 #include "lrreportdesignwindowintrerface.h"
 
 class QFileSystemWatcher;
+class QFileInfo;
 
 
 namespace LimeReport{
@@ -55,6 +56,7 @@ class PageDesignIntf;
 class PrintRange;
 class ReportDesignWindow;
 class ReportExporterInterface;
+struct CachedPage;
 
 
 class WatermarkHelper{
@@ -188,6 +190,7 @@ public:
     bool    loadFromFile(const QString& fileName, bool autoLoadPreviewOnChange);
     bool    loadFromByteArray(QByteArray *data, const QString& name = "");
     bool    loadFromString(const QString& report, const QString& name = "");
+    bool    loadFromTemplateCache(const QString& fileName, bool autoLoadPreviewOnChange = false);
     QString reportFileName(){return m_fileName;}
     void    setReportFileName(const QString& reportFileName){ m_fileName = reportFileName;}
     bool    saveToFile(const QString& fileName = "");
@@ -202,6 +205,7 @@ public:
     void emitSaveFinished();
     void emitLoadFinished();
     void emitPrintedToPDF(QString fileName);
+    void emitExportedToImage(QStringList fileNames);
     bool isSaved();
     void setCurrentReportsDir(const QString& dirName);
     QString currentReportsDir(){ return m_reportsDir;}
@@ -222,6 +226,8 @@ public:
     bool isBusy();
     bool resultIsEditable() const;
     void setResultEditable(bool value);
+    bool skipDefaultValuesOnSave() const;
+    void setSkipDefaultValuesOnSave(bool value);
     bool saveToFileIsVisible() const;
     void setSaveToFileVisible(bool value);
     bool printToPdfIsVisible() const;
@@ -268,6 +274,7 @@ signals:
     void    saveFinished();
     void    loadFinished();
     void    printedToPDF(QString fileName);
+    void    exportedToImage(QStringList fileNames);
 
     void    getAvailableDesignerLanguages(QList<QLocale::Language>* languages);
     void    currentDefaultDesignerLanguageChanged(QLocale::Language);
@@ -283,6 +290,7 @@ public slots:
     void    cancelPrinting();
 protected:
     PageDesignIntf* createPage(const QString& pageName="", bool preview = false);
+    PageDesignIntf* createCachedPage(const CachedPage& cachedPage);
     bool showPreviewWindow(ReportPages pages, PreviewHints hints, QPrinter *printer);
     void internalPrintPages(ReportPages pages, QPrinter &printer);
 protected slots:
@@ -309,9 +317,12 @@ private:
     ATranslationProperty fakeTranslationReader(){ return ATranslationProperty();}
     PageItemDesignIntf *createRenderingPage(PageItemDesignIntf *page);
     void initReport();
+    void loadDBCredentials(const QFileInfo& fileInfo);
     void paintByExternalPainter(const QString& objectName, QPainter* painter, const QStyleOptionGraphicsItem* options);
     void dropChanges(){ m_datasources->dropChanges(); m_scriptEngineContext->dropChanges();}
     void clearRenderingPages();
+    QPrinter* defaultPrinter();
+    LimeReportDesignerPluginInterface* designerFactory();
 private:
     QList<PageDesignIntf*> m_pages;
     QList<PageItemDesignIntf*> m_renderingPages;
@@ -343,6 +354,7 @@ private:
     void activateLanguage(QLocale::Language language);
     Qt::LayoutDirection m_previewLayoutDirection;
     LimeReportDesignerPluginInterface* m_designerFactory;
+    bool m_designerPluginsLoaded;
     QString m_styleSheet;
     QLocale::Language m_currentDesignerLanguage;
     QMap<QString, ReportExporterInterface*> exporters;
@@ -356,6 +368,7 @@ private:
     bool m_printToPdfVisible;
     bool m_printVisible;
     bool m_cancelPrinting;
+    bool m_skipDefaultValuesOnSave;
 };
 
 }
@@ -29,6 +29,7 @@
  ****************************************************************************/
 #include <stdexcept>
 #include <QMessageBox>
+#include <QDebug>
 
 #include "lrglobal.h"
 #include "lrreportrender.h"
@@ -149,7 +150,8 @@ void ReportRender::renameChildItems(BaseDesignIntf *item){
 ReportRender::ReportRender(QObject *parent)
     :QObject(parent), m_renderPageItem(0), m_pageCount(0),
     m_lastRenderedHeader(0), m_lastDataBand(0), m_lastRenderedFooter(0),
-    m_currentColumn(0), m_newPageStarted(false), m_lostHeadersMoved(false)
+    m_currentColumn(0), m_newPageStarted(false), m_lostHeadersMoved(false),
+    m_pageSlot(-1), m_pageCountSlot(-1), m_isLastPageFooterSlot(-1), m_isFirstPageFooterSlot(-1)
 {
     initColumns();
 }
@@ -157,6 +159,10 @@ ReportRender::ReportRender(QObject *parent)
 void ReportRender::setDatasources(DataSourceManager *value)
 {
     m_datasources=value;
+    m_pageSlot = m_datasources->renderVariableSlot("#PAGE");
+    m_pageCountSlot = m_datasources->renderVariableSlot("#PAGE_COUNT");
+    m_isLastPageFooterSlot = m_datasources->renderVariableSlot("#IS_LAST_PAGEFOOTER", true);
+    m_isFirstPageFooterSlot = m_datasources->renderVariableSlot("#IS_FIRST_PAGEFOOTER", true);
     initVariables();
     resetPageNumber(BandReset);
 }
@@ -168,10 +174,14 @@ void ReportRender::setScriptContext(ScriptEngineContext* scriptContext)
 
 void ReportRender::initDatasources(){
     try{
+        datasources()->clearSortedDataSources();
         datasources()->setAllDatasourcesToFirst();
     } catch(ReportError &exception){
         //TODO possible should thow exeption
-        QMessageBox::critical(0,tr("Error"),exception.what());
+        if (isInteractiveSession())
+            QMessageBox::critical(0,tr("Error"),exception.what());
+        else
+            qWarning() << exception.what();
         return;
     }
 }
@@ -184,7 +194,10 @@ void ReportRender::initDatasource(const QString& name){
                 ds->first();
         }
     } catch(ReportError &exception){
-        QMessageBox::critical(0,tr("Error"),exception.what());
+        if (isInteractiveSession())
+            QMessageBox::critical(0,tr("Error"),exception.what());
+        else
+            qWarning() << exception.what();
         return;
     }
 }
@@ -229,6 +242,7 @@ void ReportRender::renderPage(PageItemDesignIntf* patternPage, bool isTOC, bool
     m_patternPageItem = patternPage;
 
     analizePage(patternPage);
+    m_scriptEngineContext->initScriptBindings(patternPage);
 
     if (m_patternPageItem->resetPageNumber() && m_pageCount>0 && !isTOC) {
         resetPageNumber(PageReset);
@@ -248,11 +262,15 @@ void ReportRender::renderPage(PageItemDesignIntf* patternPage, bool isTOC, bool
     clearPageMap();
 
     try{
+        datasources()->clearSortedDataSources();
         datasources()->setAllDatasourcesToFirst();
         datasources()->clearGroupFuntionsExpressions();
     } catch(ReportError &exception){
         //TODO possible should thow exeption
-        QMessageBox::critical(0,tr("Error"),exception.what());
+        if (isInteractiveSession())
+            QMessageBox::critical(0,tr("Error"),exception.what());
+        else
+            qWarning() << exception.what();
         return;
     }
 
@@ -341,10 +359,10 @@ void ReportRender::initRenderPage()
 
 void ReportRender::initVariables()
 {
-    m_datasources->setReportVariable("#PAGE",1);
-    m_datasources->setReportVariable("#PAGE_COUNT",0);
-    m_datasources->setReportVariable("#IS_LAST_PAGEFOOTER",false);
-    m_datasources->setReportVariable("#IS_FIRST_PAGEFOOTER",false);
+    m_datasources->setRenderVariable(m_pageSlot,1);
+    m_datasources->setRenderVariable(m_pageCountSlot,0);
+    m_datasources->setRenderVariable(m_isLastPageFooterSlot,false);
+    m_datasources->setRenderVariable(m_isFirstPageFooterSlot,false);
 }
 
 void ReportRender::clearPageMap()
@@ -583,8 +601,16 @@ void ReportRender::renderDataBand(BandDesignIntf *dataBand)
     IDataSource* bandDatasource = 0;
     m_lastRenderedFooter = 0;
 
-    if (!dataBand->datasourceName().isEmpty())
-       bandDatasource = datasources()->dataSource(dataBand->datasourceName());
+    DataBandDesignIntf* sortableBand = dynamic_cast<DataBandDesignIntf*>(dataBand);
+    bool sorted = sortableBand && !sortableBand->sortBy().trimmed().isEmpty();
+
+    if (!dataBand->datasourceName().isEmpty()){
+        RenderProfileScope profileScope(datasources()->renderProfiler(), RenderProfiler::DataSource, dataBand->datasourceName());
+        if (sorted)
+            bandDatasource = datasources()->sortDataSource(dataBand->datasourceName(), sortableBand->sortBy());
+        else
+            bandDatasource = datasources()->dataSource(dataBand->datasourceName());
+    }
 
     BandDesignIntf* header = dataBand->bandHeader();
     BandDesignIntf* footer = dataBand->bandFooter();
@@ -593,8 +619,22 @@ void ReportRender::renderDataBand(BandDesignIntf *dataBand)
 
     if(bandDatasource && !bandDatasource->eof() && !m_renderCanceled){
 
-        QString varName = QLatin1String("line_")+dataBand->objectName().toLower();
-        datasources()->setReportVariable(varName,1);
+        int lineSlot = datasources()->renderVariableSlot(QLatin1String("line_")+dataBand->objectName().toLower());
+        datasources()->setRenderVariable(lineSlot,1);
+
+        // line counters of the nested group headers, incremented after each row
+        QVector<int> groupLineSlots;
+        QList<BandDesignIntf *> bandList = dataBand->childrenByType(BandDesignIntf::GroupHeader);
+        while (bandList.size() > 0)
+        {
+            QList<BandDesignIntf *> childList;
+            foreach (BandDesignIntf* band, bandList)
+            {
+                childList.append(band->childrenByType(BandDesignIntf::GroupHeader));
+                groupLineSlots.append(datasources()->renderVariableSlot(QLatin1String("line_")+band->objectName().toLower()));
+            }
+            bandList = childList;
+        }
 
         if (header && header->reprintOnEachPage())
             m_reprintableBands.append(dataBand->bandHeader());
@@ -624,7 +664,11 @@ void ReportRender::renderDataBand(BandDesignIntf *dataBand)
                 if (dataBand->keepFooterTogether() && !bandDatasource->hasNext())
                     openFooterGroup(dataBand);
 
-                datasources()->updateChildrenData(dataBand->datasourceName());
+                {
+                    RenderProfileScope profileScope(datasources()->renderProfiler(), RenderProfiler::DataSource,
+                                                    "", dataBand->datasourceName(), " children");
+                    datasources()->updateChildrenData(dataBand->datasourceName());
+                }
                 m_lastDataBand = dataBand;
 
                 if (header && !firstTime && header->repeatOnEachRow())
@@ -636,26 +680,17 @@ void ReportRender::renderDataBand(BandDesignIntf *dataBand)
 
             }
 
-            bandDatasource->next();
+            {
+                RenderProfileScope profileScope(datasources()->renderProfiler(), RenderProfiler::DataSource, dataBand->datasourceName());
+                bandDatasource->next();
+            }
 
-            datasources()->setReportVariable(varName,datasources()->variable(varName).toInt()+1);
+            datasources()->incrementRenderVariable(lineSlot);
 
-            QList<BandDesignIntf *> bandList;
-            QList<BandDesignIntf *> childList;
-
-            bandList = dataBand->childrenByType(BandDesignIntf::GroupHeader);
-            while (bandList.size() > 0)
+            foreach (int groupLineSlot, groupLineSlots)
             {
-                childList.clear();
-                foreach (BandDesignIntf* band, bandList)
-                {
-                    childList.append(band->childrenByType(BandDesignIntf::GroupHeader));
-
-                    QString groupLineVar = QLatin1String("line_")+band->objectName().toLower();
-                    if (datasources()->containsVariable(groupLineVar))
-                        datasources()->setReportVariable(groupLineVar,datasources()->variable(groupLineVar).toInt()+1);
-                }
-                bandList = childList;
+                if (datasources()->isRenderVariableSet(groupLineSlot))
+                    datasources()->incrementRenderVariable(groupLineSlot);
             }
 
             renderGroupHeader(dataBand, bandDatasource, false);
@@ -678,7 +713,7 @@ void ReportRender::renderDataBand(BandDesignIntf *dataBand)
                 m_reprintableBands.removeOne(dataBand);
         }
 
-        datasources()->deleteVariable(varName);
+        datasources()->unsetRenderVariable(lineSlot);
 
     } else if (bandDatasource==0) {
         renderBand(dataBand, 0, StartNewPageAsNeeded);
@@ -689,13 +724,16 @@ void ReportRender::renderDataBand(BandDesignIntf *dataBand)
         if (dataBand->keepFooterTogether())
             m_reprintableBands.removeOne(dataBand);
     }
+
+    if (sorted && !dataBand->datasourceName().isEmpty())
+        datasources()->removeSortedDataSource(dataBand->datasourceName());
 }
 
 void ReportRender::renderPageHeader(PageItemDesignIntf *patternPage)
 {
     BandDesignIntf* band = patternPage->bandByType(BandDesignIntf::PageHeader);
     if (band){
-        if (m_datasources->variable("#PAGE").toInt()!=1 ||
+        if (m_datasources->renderVariable(m_pageSlot)!=1 ||
             band->property("printOnFirstPage").toBool()
         )
             renderBand(band, 0);
@@ -756,7 +794,7 @@ qreal ReportRender::calcPageFooterHeight(PageItemDesignIntf *patternPage)
 {
     BandDesignIntf* band = patternPage->bandByType(BandDesignIntf::PageFooter);
     if (band){
-        if (m_datasources->variable("#PAGE")!=1)
+        if (m_datasources->renderVariable(m_pageSlot)!=1)
             return band->height();
         else if (band->property("printOnFirstPage").toBool())
             return band->height();
@@ -1197,8 +1235,8 @@ void ReportRender::secondRenderPass(ReportPages renderedPages)
 
     for(int i = 0; i < renderedPages.count(); ++i){
         PageItemDesignIntf::Ptr page = renderedPages.at(i);
-        m_datasources->setReportVariable("#PAGE",m_pagesRanges.findPageNumber(i));
-        m_datasources->setReportVariable("#PAGE_COUNT",m_pagesRanges.findLastPageNumber(i));
+        m_datasources->setRenderVariable(m_pageSlot,m_pagesRanges.findPageNumber(i));
+        m_datasources->setRenderVariable(m_pageCountSlot,m_pagesRanges.findLastPageNumber(i));
         foreach(BaseDesignIntf* item, page->childBaseItems()){
             if (item->isNeedUpdateSize(SecondPass))
                 item->updateItemSize(m_datasources, SecondPass);
@@ -1251,9 +1289,10 @@ BandDesignIntf *ReportRender::saveUppperPartReturnBottom(BandDesignIntf *band, i
 
 BandDesignIntf *ReportRender::renderData(BandDesignIntf *patternBand)
 {
+    RenderProfileScope profileScope(datasources()->renderProfiler(), RenderProfiler::Band, patternBand->objectName());
     BandDesignIntf* bandClone = dynamic_cast<BandDesignIntf*>(patternBand->cloneItem(PreviewMode));
 
-    m_scriptEngineContext->baseDesignIntfToScript(patternBand->parent()->objectName(), bandClone);
+    m_scriptEngineContext->bindRenderedItem(patternBand->parent()->objectName(), bandClone);
     m_scriptEngineContext->setCurrentBand(bandClone);
     emit(patternBand->beforeRender());
 
@@ -1325,7 +1364,7 @@ void ReportRender::resetPageNumber(ResetPageNuberType resetType)
 {
     m_pagesRanges.startNewRange();
     if (resetType == PageReset)
-        m_datasources->setReportVariable("#PAGE",1);
+        m_datasources->setRenderVariable(m_pageSlot,1);
 }
 
 void ReportRender::cutGroups()
@@ -1478,8 +1517,8 @@ void ReportRender::savePage(bool isLast)
     else
         m_pagesRanges.addPage();
 
-    m_datasources->setReportVariable("#IS_LAST_PAGEFOOTER",isLast);
-    m_datasources->setReportVariable("#IS_FIRST_PAGEFOOTER",m_datasources->variable("#PAGE").toInt()==1);
+    m_datasources->setRenderVariable(m_isLastPageFooterSlot,isLast);
+    m_datasources->setRenderVariable(m_isFirstPageFooterSlot,m_datasources->renderVariable(m_pageSlot)==1);
 
     renderPageItems(m_patternPageItem);
     checkFooterGroup(m_lastDataBand);
@@ -1488,10 +1527,10 @@ void ReportRender::savePage(bool isLast)
     m_columnedBandItems.clear();
 
     BandDesignIntf* pf = m_patternPageItem->bandByType(BandDesignIntf::PageFooter);
-    if (pf && m_datasources->variable("#PAGE").toInt()!=1 && !isLast){
+    if (pf && m_datasources->renderVariable(m_pageSlot)!=1 && !isLast){
         renderPageFooter(m_patternPageItem);
     } else {
-        if (pf && pf->property("printOnFirstPage").toBool() && m_datasources->variable("#PAGE").toInt()==1){
+        if (pf && pf->property("printOnFirstPage").toBool() && m_datasources->renderVariable(m_pageSlot)==1){
             renderPageFooter(m_patternPageItem);
         } else if(pf && pf->property("printOnLastPage").toBool() && isLast){
             renderPageFooter(m_patternPageItem);
@@ -1499,9 +1538,9 @@ void ReportRender::savePage(bool isLast)
     }
 
     if (m_pagesRanges.currentRange(m_patternPageItem->isTOC()).firstPage == 0) {
-        m_datasources->setReportVariable("#PAGE",1);
+        m_datasources->setRenderVariable(m_pageSlot,1);
     } else {
-        m_datasources->setReportVariable("#PAGE",m_datasources->variable("#PAGE").toInt()+1);
+        m_datasources->incrementRenderVariable(m_pageSlot);
     }
 
     BandDesignIntf* pageFooter = m_renderPageItem->bandByType(BandDesignIntf::PageFooter);
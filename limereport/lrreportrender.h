@@ -221,6 +221,10 @@ private:
     unsigned long long m_currentNameIndex;
     bool            m_newPageStarted;
     bool            m_lostHeadersMoved;
+    int             m_pageSlot;
+    int             m_pageCountSlot;
+    int             m_isLastPageFooterSlot;
+    int             m_isFirstPageFooterSlot;
 
 
 };
@@ -32,10 +32,12 @@
 #include <QDate>
 #include <QStringList>
 #include <QUuid>
+#include <QMetaProperty>
 #ifdef USE_QTSCRIPTENGINE
 #include <QScriptValueIterator>
 #endif
 #include <QMessageBox>
+#include <QDebug>
 #ifdef HAVE_UI_LOADER
 #include <QUiLoader>
 #include <QBuffer>
@@ -488,9 +490,500 @@ QString ScriptEngineManager::expandScripts(QString context, QVariant& varValue,
     return context;
 }
 
+namespace {
+
+const int NATIVE_EXPRESSION_MAX_DEPTH = 16;
+
+void skipSpaces(const QString& body, int& pos)
+{
+    while (pos < body.length() && body.at(pos).isSpace()) ++pos;
+}
+
+int nativeFunctionMaxArguments(const QString& name)
+{
+    if (name == "numberFormat") return 4;
+    if (name == "dateFormat" || name == "dateTimeFormat") return 3;
+    if (name == "timeFormat" || name == "sectotimeFormat" ||
+        name == "currencyFormat" || name == "currencyUSBasedFormat") return 2;
+    if (name == "line" || name == "getVariable" || name == "getField") return 1;
+    return 0;
+}
+
+// Value a $D{} (isField) or an unquoted $V{} reference reads back as once it
+// is pasted into the script source, the way expandDataFields/expandUserVariables
+// do it; false when the pasted text would not be a plain literal.
+bool scriptLiteralValue(bool isField, const QVariant& value, QVariant& result)
+{
+    if (isField && value.isNull()){
+        result = QString("");
+        return true;
+    }
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+        if (!qIsFinite(value.toDouble())) return false;
+        result = value;
+        return true;
+    case QVariant::Bool:
+        result = value;
+        return true;
+    case QVariant::Char:
+    case QVariant::String:
+    case QVariant::StringList:
+    case QVariant::Date:
+    case QVariant::DateTime:
+        if (isField){
+            // fields reach the script as string literals
+            QString text = value.toString();
+            if (text.contains('\\')) return false;
+            result = text;
+            return true;
+        } else {
+            // variables only when their text is a number or boolean literal
+            QString text = value.toString().trimmed();
+            if (text == "true" || text == "false"){
+                result = (text == "true");
+                return true;
+            }
+            bool ok = false;
+            double number = text.toDouble(&ok);
+            if (!ok || !qIsFinite(number) || (text.length() > 1 && text.at(0) == '0' && text.at(1).isDigit()))
+                return false;
+            result = number;
+            return true;
+        }
+    default:
+        return false;
+    }
+}
+
+bool nativeResultText(const QVariant& value, QString& result)
+{
+    // only values whose text is the same as the script engine would print
+    switch (value.type()) {
+    case QVariant::Invalid:
+        result = "undefined";
+        return true;
+    case QVariant::Char:
+    case QVariant::String:
+        result = value.toString();
+        return true;
+    case QVariant::Bool:
+        result = value.toBool() ? "true" : "false";
+        return true;
+    case QVariant::Int:
+    case QVariant::UInt:
+        result = value.toString();
+        return true;
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:{
+        double number = value.toDouble();
+        if (!qIsFinite(number)) return false;
+        if (number == 0){
+            result = "0";
+            return true;
+        }
+        if (qAbs(number) < 1e-5 || qAbs(number) >= 1e15) return false;
+        result = QString::number(number, 'g', 15);
+        return result.toDouble() == number;
+    }
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+ScriptEngineManager::NativeScript ScriptEngineManager::parseNativeScript(const QString &body)
+{
+    NativeScript result;
+    int pos = 0;
+    if (!parseNativeExpression(body, pos, result.expression, 0) ||
+        result.expression.kind != NativeExpression::Call)
+        return result;
+    skipSpaces(body, pos);
+    if (pos < body.length() && body.at(pos) == ';'){
+        ++pos;
+        skipSpaces(body, pos);
+    }
+    result.isNative = (pos == body.length());
+    return result;
+}
+
+bool ScriptEngineManager::parseNativeExpression(const QString &body, int &pos, NativeExpression &expression, int depth)
+{
+    if (depth > NATIVE_EXPRESSION_MAX_DEPTH) return false;
+    skipSpaces(body, pos);
+    if (pos >= body.length()) return false;
+    QChar c = body.at(pos);
+
+    if (c == '$'){
+        QRegExp fieldRx(Const::FIELD_RX);
+        if (fieldRx.indexIn(body, pos) == pos){
+            expression.kind = NativeExpression::Field;
+            expression.name = fieldRx.cap(1);
+            pos += fieldRx.matchedLength();
+            return true;
+        }
+        QRegExp variableRx(Const::VARIABLE_RX);
+        if (variableRx.indexIn(body, pos) == pos && !variableRx.cap(1).isEmpty()){
+            expression.kind = NativeExpression::Variable;
+            expression.name = variableRx.cap(1);
+            pos += variableRx.matchedLength();
+            return true;
+        }
+        return false;
+    }
+
+    if (c == '"' || c == '\''){
+        int end = body.indexOf(c, pos + 1);
+        if (end == -1) return false;
+        QString text = body.mid(pos + 1, end - pos - 1);
+        if (text.contains('\\') || text.contains('\n')) return false;
+        pos = end + 1;
+        QRegExp variableRx(Const::VARIABLE_RX);
+        if (variableRx.exactMatch(text) && !variableRx.cap(1).isEmpty()){
+            expression.kind = NativeExpression::QuotedVariable;
+            expression.name = variableRx.cap(1);
+            return true;
+        }
+        if (text.contains('$')) return false;
+        expression.kind = NativeExpression::Literal;
+        expression.value = text;
+        return true;
+    }
+
+    if (c.isDigit() || c == '-' || c == '.'){
+        QRegExp numberRx("-?(?:\\d+\\.?\\d*|\\.\\d+)(?:[eE][+-]?\\d+)?");
+        if (numberRx.indexIn(body, pos) != pos) return false;
+        QString text = numberRx.cap(0);
+        if ((text.at(0) == '0' && text.length() > 1 && text.at(1).isDigit()) ||
+            (text.startsWith("-0") && text.length() > 2 && text.at(2).isDigit()))
+            return false;
+        expression.kind = NativeExpression::Literal;
+        expression.value = text.toDouble();
+        pos += numberRx.matchedLength();
+        return true;
+    }
+
+    if (c.isLetter() || c == '_'){
+        int start = pos;
+        while (pos < body.length() && (body.at(pos).isLetterOrNumber() || body.at(pos) == '_')) ++pos;
+        QString name = body.mid(start, pos - start);
+        if (name == "true" || name == "false"){
+            expression.kind = NativeExpression::Literal;
+            expression.value = (name == "true");
+            return true;
+        }
+        bool isGroupFunction = dataManager() && dataManager()->groupFunctionNames().contains(name);
+        int maxArguments = isGroupFunction ? 2 : nativeFunctionMaxArguments(name);
+        if (maxArguments == 0) return false;
+        skipSpaces(body, pos);
+        if (pos >= body.length() || body.at(pos) != '(') return false;
+        ++pos;
+        expression.kind = NativeExpression::Call;
+        expression.name = name;
+        skipSpaces(body, pos);
+        if (pos < body.length() && body.at(pos) == ')'){
+            ++pos;
+        } else {
+            while (true){
+                NativeExpression argument;
+                if (!parseNativeExpression(body, pos, argument, depth + 1)) return false;
+                expression.arguments.append(argument);
+                skipSpaces(body, pos);
+                if (pos >= body.length()) return false;
+                if (body.at(pos) == ')'){
+                    ++pos;
+                    break;
+                }
+                if (body.at(pos) != ',') return false;
+                ++pos;
+            }
+        }
+        int count = expression.arguments.count();
+        return isGroupFunction ? count == 2 : (count > 0 && count <= maxArguments);
+    }
+
+    return false;
+}
+
+bool ScriptEngineManager::evaluateNativeExpression(const NativeExpression &expression, QVariant &result)
+{
+    switch (expression.kind) {
+    case NativeExpression::Literal:
+        result = expression.value;
+        return true;
+    case NativeExpression::Field:
+        if (!dataManager()->containsField(expression.name)) return false;
+        return scriptLiteralValue(true, dataManager()->fieldData(expression.name), result);
+    case NativeExpression::Variable:
+        if (!dataManager()->containsVariable(expression.name)) return false;
+        return scriptLiteralValue(false, dataManager()->variable(expression.name), result);
+    case NativeExpression::QuotedVariable:
+        if (!dataManager()->containsVariable(expression.name)) return false;
+        result = dataManager()->variable(expression.name).toString();
+        return true;
+    case NativeExpression::Call:{
+        QVariantList arguments;
+        foreach(const NativeExpression& argument, expression.arguments){
+            QVariant value;
+            if (!evaluateNativeExpression(argument, value)) return false;
+            arguments.append(value);
+        }
+        return callNativeFunction(expression.name, arguments, result);
+    }
+    }
+    return false;
+}
+
+bool ScriptEngineManager::callNativeFunction(const QString &name, const QVariantList &arguments, QVariant &result)
+{
+    // defaults are the ones of the script wrappers created in createXxxFunction()
+    QVariant value = arguments.at(0);
+    QString second = arguments.count() > 1 ? arguments.at(1).toString() : QString();
+    QString third = arguments.count() > 2 ? arguments.at(2).toString() : QString();
+    if (name == "numberFormat"){
+        if (arguments.count() > 1 && second.isEmpty()) return false;
+        char format = arguments.count() > 1 ? second.at(0).toLatin1() : 'f';
+        int precision = arguments.count() > 2 ? arguments.at(2).toInt() : 2;
+        QString locale = arguments.count() > 3 ? arguments.at(3).toString() : QString();
+        result = m_functionManager->numberFormat(value, format, precision, locale);
+    } else if (name == "dateFormat"){
+        result = m_functionManager->dateFormat(value, arguments.count() > 1 ? second : QString("dd.MM.yyyy"), third);
+    } else if (name == "timeFormat"){
+        result = m_functionManager->timeFormat(value, arguments.count() > 1 ? second : QString("hh:mm"));
+    } else if (name == "dateTimeFormat"){
+        result = m_functionManager->dateTimeFormat(value, arguments.count() > 1 ? second : QString("dd.MM.yyyy hh:mm"), third);
+    } else if (name == "sectotimeFormat"){
+        result = m_functionManager->sectotimeFormat(value, arguments.count() > 1 ? second : QString("hh:mm:ss"));
+    } else if (name == "currencyFormat"){
+        result = m_functionManager->currencyFormat(value, second);
+    } else if (name == "currencyUSBasedFormat"){
+        result = m_functionManager->currencyUSBasedFormat(value, second);
+    } else if (name == "line"){
+        result = m_functionManager->line(value.toString());
+    } else if (name == "getVariable"){
+        result = m_functionManager->getVariable(value.toString());
+    } else if (name == "getField"){
+        result = m_functionManager->getField(value.toString());
+    } else {
+        result = m_functionManager->calcGroupFunction(name, value.toString(), second);
+    }
+    return true;
+}
+
+bool ScriptEngineManager::callNativeScript(const QString &body, QVariant &varValue, QString &result)
+{
+    if (!dataManager()) return false;
+    QHash<QString, NativeScript>::iterator it = m_nativeScripts.find(body);
+    if (it == m_nativeScripts.end()){
+        if (m_nativeScripts.count() >= Const::COMPILED_SCRIPTS_CACHE_LIMIT)
+            m_nativeScripts.clear();
+        it = m_nativeScripts.insert(body, parseNativeScript(body));
+    }
+    if (!it.value().isNative) return false;
+
+    QVariant value;
+    try {
+        if (!evaluateNativeExpression(it.value().expression, value)) return false;
+    } catch (ReportError&){
+        return false;
+    }
+    if (!nativeResultText(value, result)) return false;
+    varValue = value;
+    return true;
+}
+
+#ifdef USE_QJSENGINE
+namespace {
+
+struct ScriptReference{
+    int pos;
+    int length;
+    QString name;
+    bool isField;
+    bool quoted;
+};
+
+bool referenceLessThan(const ScriptReference& r1, const ScriptReference& r2)
+{
+    return r1.pos < r2.pos;
+}
+
+bool scriptArgumentValue(bool isField, bool quoted, const QVariant& value, QJSValue& result)
+{
+    // reproduces the value the textual substitution would put into the script source
+    if (quoted){
+        QString text = value.toString();
+        if (text.contains('\\')) return false;
+        result = QJSValue(text);
+        return true;
+    }
+    QVariant literal;
+    if (!scriptLiteralValue(isField, value, literal)) return false;
+    switch (literal.type()) {
+    case QVariant::Bool:
+        result = QJSValue(literal.toBool());
+        break;
+    case QVariant::String:
+        result = QJSValue(literal.toString());
+        break;
+    default:
+        result = QJSValue(literal.toDouble());
+    }
+    return true;
+}
+
+} // namespace
+
+ScriptEngineManager::CompiledScript ScriptEngineManager::compileScript(const QString &body, ScriptEngineType *se)
+{
+    CompiledScript result;
+
+    QList< QPair<int,int> > literals;
+    for (int i = 0; i < body.length(); ++i){
+        QChar c = body.at(i);
+        if (c == '"' || c == '\'' || c == '`'){
+            int start = i++;
+            while (i < body.length() && body.at(i) != c){
+                if (body.at(i) == '\\') ++i;
+                ++i;
+            }
+            literals.append(qMakePair(start, qMin(i, body.length()-1)));
+        } else if (c == '/' && i+1 < body.length() && (body.at(i+1) == '/' || body.at(i+1) == '*')){
+            return result;
+        }
+    }
+
+    QList<ScriptReference> references;
+    QRegExp fieldRx(Const::FIELD_RX);
+    int pos = 0;
+    while ((pos = fieldRx.indexIn(body, pos)) != -1){
+        ScriptReference reference = {pos, fieldRx.matchedLength(), fieldRx.cap(1), true, false};
+        references.append(reference);
+        pos += fieldRx.matchedLength();
+    }
+    QRegExp variableRx(Const::VARIABLE_RX);
+    pos = 0;
+    while ((pos = variableRx.indexIn(body, pos)) != -1){
+        if (variableRx.cap(1).isEmpty()) return result;
+        ScriptReference reference = {pos, variableRx.matchedLength(), variableRx.cap(1), false, false};
+        references.append(reference);
+        pos += variableRx.matchedLength();
+    }
+    qSort(references.begin(), references.end(), referenceLessThan);
+
+    for (int i = 0; i < references.count(); ++i){
+        ScriptReference& reference = references[i];
+        for (int j = 0; j < literals.count(); ++j){
+            const QPair<int,int>& literal = literals.at(j);
+            if (reference.pos < literal.first || reference.pos > literal.second) continue;
+            if (reference.isField || literal.first != reference.pos-1 ||
+                literal.second != reference.pos + reference.length || body.at(literal.first) == '`')
+                return result;
+            reference.quoted = true;
+            reference.pos--;
+            reference.length += 2;
+            break;
+        }
+    }
+
+    QHash<QString, int> argumentIndex;
+    QStringList parameters;
+    QString source;
+    pos = 0;
+    foreach(const ScriptReference& reference, references){
+        if (reference.pos < pos) return result;
+        ScriptArgument::Kind kind = reference.isField ? ScriptArgument::Field :
+                                    reference.quoted ? ScriptArgument::QuotedVariable : ScriptArgument::Variable;
+        QString key = QString::number(kind) + reference.name;
+        if (!argumentIndex.contains(key)){
+            ScriptArgument argument;
+            argument.kind = kind;
+            argument.name = reference.name;
+            argumentIndex.insert(key, result.arguments.count());
+            parameters.append(QString("__lr_arg%1").arg(result.arguments.count()));
+            result.arguments.append(argument);
+        }
+        source += body.mid(pos, reference.pos - pos);
+        source += parameters.at(argumentIndex.value(key));
+        pos = reference.pos + reference.length;
+    }
+    source += body.mid(pos);
+
+    // scripts that are not a single expression fail here and keep the textual path
+    ScriptValueType function = se->evaluate(
+        QString("(function(%1){ return (\n%2\n); })").arg(parameters.join(",")).arg(source)
+    );
+    if (!function.isError() && function.isCallable()){
+        result.function = function;
+        result.isCompiled = true;
+    }
+    return result;
+}
+
+bool ScriptEngineManager::callCompiledScript(const QString &body, ScriptEngineType *se, QVariant &varValue, ScriptValueType &result)
+{
+    QHash<QString, CompiledScript>::iterator it = m_compiledScripts.find(body);
+    if (it == m_compiledScripts.end()){
+        if (m_compiledScripts.count() >= Const::COMPILED_SCRIPTS_CACHE_LIMIT)
+            m_compiledScripts.clear();
+        it = m_compiledScripts.insert(body, compileScript(body, se));
+    }
+    if (!it.value().isCompiled) return false;
+
+    QJSValueList arguments;
+    QVariant lastValue;
+    try {
+        foreach(const ScriptArgument& argument, it.value().arguments){
+            QVariant value;
+            if (argument.kind == ScriptArgument::Field){
+                if (!dataManager()->containsField(argument.name)) return false;
+                value = dataManager()->fieldData(argument.name);
+            } else {
+                if (!dataManager()->containsVariable(argument.name)) return false;
+                value = dataManager()->variable(argument.name);
+            }
+            QJSValue jsValue;
+            if (!scriptArgumentValue(argument.kind == ScriptArgument::Field,
+                                     argument.kind == ScriptArgument::QuotedVariable, value, jsValue))
+                return false;
+            arguments.append(jsValue);
+            lastValue = value;
+        }
+    } catch (ReportError&){
+        return false;
+    }
+
+    if (!arguments.isEmpty()) varValue = lastValue;
+    result = it.value().function.call(arguments);
+    return true;
+}
+#endif
+
 QString ScriptEngineManager::replaceScripts(QString context, QVariant &varValue, QObject *reportItem, ScriptEngineType* se, ScriptNode *scriptTree)
 {
     foreach(ScriptNode* item, scriptTree->children()){
+        RenderProfileScope profileScope(dataManager() ? dataManager()->renderProfiler() : 0,
+                                        RenderProfiler::Script, item->body(), Const::PROFILE_SCRIPT_NAME_LENGTH);
+        QString nativeValue;
+        if (item->children().isEmpty() && callNativeScript(item->body(), varValue, nativeValue)){
+            context.replace(item->script(), nativeValue);
+            continue;
+        }
+#ifdef USE_QJSENGINE
+        ScriptValueType compiledValue;
+        if (item->children().isEmpty() && callCompiledScript(item->body(), se, varValue, compiledValue)){
+            if (!compiledValue.isError()) varValue = compiledValue.toVariant();
+            context.replace(item->script(), compiledValue.toString());
+            continue;
+        }
+#endif
         QString scriptBody = expandDataFields(item->body(), EscapeSymbols, varValue, reportItem);
         if (item->children().size() > 0)
             scriptBody = replaceScripts(scriptBody, varValue, reportItem, se, item);
@@ -1204,6 +1697,9 @@ void ScriptEngineContext::clear()
 #endif
     m_initScript.clear();
     m_tableOfContents->clear();
+    m_scriptReferences.clear();
+    m_referencedBands.clear();
+    m_scriptBindingsReady = false;
     m_lastError="";
 }
 
@@ -1388,6 +1884,86 @@ void ScriptEngineContext::baseDesignIntfToScript(const QString& pageName, BaseDe
     }
 }
 
+namespace {
+
+QString scriptObjectName(const QString& pageName, BaseDesignIntf* item)
+{
+    return item->patternName().compare(pageName) == 0 ? pageName : pageName+"_"+item->patternName();
+}
+
+} // namespace
+
+void ScriptEngineContext::initScriptBindings(BaseDesignIntf* patternPage)
+{
+    m_scriptReferences.clear();
+    m_referencedBands.clear();
+    collectScriptReferences(m_initScript);
+    collectScriptReferences(patternPage);
+    m_scriptBindingsReady = true;
+}
+
+void ScriptEngineContext::collectScriptReferences(const QString& script)
+{
+    QRegExp rx("[A-Za-z_]\\w*");
+    int pos = 0;
+    while ((pos = rx.indexIn(script, pos)) != -1){
+        m_scriptReferences.insert(rx.cap(0));
+        pos += rx.matchedLength();
+    }
+}
+
+void ScriptEngineContext::collectScriptReferences(BaseDesignIntf* item)
+{
+    if (!item) return;
+    const QMetaObject* mo = item->metaObject();
+    for (int i = 0; i < mo->propertyCount(); ++i){
+        QMetaProperty property = mo->property(i);
+        if (property.type() != QVariant::String) continue;
+        QString value = property.read(item).toString();
+        if (value.contains("$S")) collectScriptReferences(value);
+    }
+    foreach(BaseDesignIntf* child, item->childBaseItems()){
+        collectScriptReferences(child);
+    }
+}
+
+bool ScriptEngineContext::hasScriptReferences(const QString& pageName, BaseDesignIntf* item)
+{
+    if (m_scriptReferences.contains(scriptObjectName(pageName, item))) return true;
+    ChildBaseItemsIterator it(item);
+    while (it.hasNext()){
+        if (hasScriptReferences(pageName, it.next())) return true;
+    }
+    return false;
+}
+
+void ScriptEngineContext::bindReferencedItems(const QString& pageName, BaseDesignIntf* item)
+{
+    QString name = scriptObjectName(pageName, item);
+    if (m_scriptReferences.contains(name)) qobjectToScript(name, item);
+    ChildBaseItemsIterator it(item);
+    while (it.hasNext()){
+        bindReferencedItems(pageName, it.next());
+    }
+}
+
+void ScriptEngineContext::bindRenderedItem(const QString& pageName, BaseDesignIntf* item)
+{
+    if (!item) return;
+    if (!m_scriptBindingsReady){
+        baseDesignIntfToScript(pageName, item);
+        return;
+    }
+    // clones never emit the render signals and never carry script connections,
+    // so unlike baseDesignIntfToScript() there is nothing to disconnect here
+    QString name = scriptObjectName(pageName, item);
+    QHash<QString, bool>::iterator it = m_referencedBands.find(name);
+    if (it == m_referencedBands.end())
+        it = m_referencedBands.insert(name, hasScriptReferences(pageName, item));
+    if (it.value())
+        bindReferencedItems(pageName, item);
+}
+
 void ScriptEngineContext::qobjectToScript(const QString& name, QObject *item)
 {
     ScriptEngineType* engine = ScriptEngineManager::instance().scriptEngine();
@@ -1443,18 +2019,22 @@ bool ScriptEngineContext::runInitScript(){
     if (res.isBool()) return res.toBool();
 #ifdef  USE_QJSENGINE
     if (res.isError()){
-        QMessageBox::critical(0,tr("Error"),
-            QString("Line %1: %2 ").arg(res.property("lineNumber").toString())
-                                   .arg(res.toString())
-        );
+        QString message = QString("Line %1: %2 ").arg(res.property("lineNumber").toString())
+                                                 .arg(res.toString());
+        if (isInteractiveSession())
+            QMessageBox::critical(0,tr("Error"),message);
+        else
+            qWarning() << message;
         return false;
     }
 #else
     if (engine->hasUncaughtException()) {
-        QMessageBox::critical(0,tr("Error"),
-            QString("Line %1: %2 ").arg(engine->uncaughtExceptionLineNumber())
-                                   .arg(engine->uncaughtException().toString())
-        );
+        QString message = QString("Line %1: %2 ").arg(engine->uncaughtExceptionLineNumber())
+                                                 .arg(engine->uncaughtException().toString());
+        if (isInteractiveSession())
+            QMessageBox::critical(0,tr("Error"),message);
+        else
+            qWarning() << message;
         return false;
     }
 #endif
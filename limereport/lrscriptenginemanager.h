@@ -34,6 +34,7 @@
 #include <QScriptable>
 #endif
 #include <QVector>
+#include <QSet>
 #include <QIcon>
 #include <QAbstractItemModel>
 #include <QDebug>
@@ -179,7 +180,8 @@ public:
 #endif
     explicit ScriptEngineContext(QObject* parent=0):
         QObject(parent), m_currentBand(0), m_currentPage(0),
-        m_tableOfContents(new TableOfContents(this)), m_hasChanges(false) {}
+        m_tableOfContents(new TableOfContents(this)), m_hasChanges(false),
+        m_scriptBindingsReady(false) {}
 #ifdef HAVE_UI_LOADER
     void    addDialog(const QString& name, const QByteArray& description);
     bool    changeDialog(const QString& name, const QByteArray &description);
@@ -194,6 +196,8 @@ public:
 #endif
     void    baseDesignIntfToScript(const QString& pageName, BaseDesignIntf *item);
     void    qobjectToScript(const QString &name, QObject* item);
+    void    initScriptBindings(BaseDesignIntf* patternPage);
+    void    bindRenderedItem(const QString& pageName, BaseDesignIntf* item);
     void    clear();
     QString initScript() const;
     void    setInitScript(const QString& initScript);
@@ -225,6 +229,10 @@ protected:
     QDialog *findDialog(const QString &dialogName);
     DialogDescriber* findDialogContainer(const QString& dialogName);
 #endif
+    void     collectScriptReferences(const QString& script);
+    void     collectScriptReferences(BaseDesignIntf* item);
+    bool     hasScriptReferences(const QString& pageName, BaseDesignIntf* item);
+    void     bindReferencedItems(const QString& pageName, BaseDesignIntf* item);
 private:
 #ifdef HAVE_UI_LOADER
     QVector<DialogDescriber::Ptr> m_dialogs;
@@ -237,6 +245,11 @@ private:
     TableOfContents* m_tableOfContents;
     bool m_hasChanges;
     ReportPages* m_reportPages;
+    // identifiers used by the init script and the $S{} expressions of the page
+    // being rendered; only items named there are rebound to their clones
+    QSet<QString> m_scriptReferences;
+    QHash<QString, bool> m_referencedBands;
+    bool m_scriptBindingsReady;
 };
 
 class JSFunctionDesc{
@@ -498,6 +511,43 @@ private:
     bool createAddTableOfContentsItemFunction();
     bool createClearTableOfContentsFunction();
     bool createReopenDatasourceFunction();
+    // $S{} bodies made only of built-in function calls with literal, $D{} and $V{}
+    // arguments are evaluated directly through ScriptFunctionsManager
+    struct NativeExpression{
+        enum Kind{Literal, Field, Variable, QuotedVariable, Call};
+        NativeExpression():kind(Literal){}
+        Kind kind;
+        QString name;
+        QVariant value;
+        QList<NativeExpression> arguments;
+    };
+    struct NativeScript{
+        NativeScript():isNative(false){}
+        bool isNative;
+        NativeExpression expression;
+    };
+    NativeScript parseNativeScript(const QString& body);
+    bool parseNativeExpression(const QString& body, int& pos, NativeExpression& expression, int depth);
+    bool evaluateNativeExpression(const NativeExpression& expression, QVariant& result);
+    bool callNativeFunction(const QString& name, const QVariantList& arguments, QVariant& result);
+    bool callNativeScript(const QString& body, QVariant& varValue, QString& result);
+#ifdef USE_QJSENGINE
+    // $S{} bodies without nested scripts are compiled once into a function;
+    // their $D{} and $V{} references become the function arguments
+    struct ScriptArgument{
+        enum Kind{Field, Variable, QuotedVariable};
+        Kind kind;
+        QString name;
+    };
+    struct CompiledScript{
+        CompiledScript():isCompiled(false){}
+        bool isCompiled;
+        ScriptValueType function;
+        QVector<ScriptArgument> arguments;
+    };
+    CompiledScript compileScript(const QString& body, ScriptEngineType* se);
+    bool callCompiledScript(const QString& body, ScriptEngineType* se, QVariant& varValue, ScriptValueType& result);
+#endif
 private:
     ScriptEngineManager();
     ScriptEngineType*  m_scriptEngine;
@@ -507,6 +557,10 @@ private:
     ScriptEngineContext* m_context;
     DataSourceManager* m_dataManager;
     ScriptFunctionsManager* m_functionManager;
+    QHash<QString, NativeScript> m_nativeScripts;
+#ifdef USE_QJSENGINE
+    QHash<QString, CompiledScript> m_compiledScripts;
+#endif
 };
 
 
@@ -0,0 +1,368 @@
+#include "lrsorteddatasource.h"
+#include "lrglobal.h"
+
+#include <QBitArray>
+#include <QDateTime>
+#include <QObject>
+#include <QRegExp>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace LimeReport{
+
+namespace {
+
+struct SortKey{
+    enum KeyType{AutoKey, NumberKey, DateKey, StringKey};
+    SortKey():type(AutoKey), descending(false){}
+    KeyType type;
+    bool descending;
+    QBitArray nulls;
+    QVector<double> numbers;
+    QVector<QString> strings;
+};
+
+bool isNumericVariant(const QVariant& value)
+{
+    switch (value.type()) {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+    case QVariant::Bool:
+    case QVariant::Date:
+    case QVariant::DateTime:
+    case QVariant::Time:
+        return true;
+    default:
+        return value.userType() == QMetaType::Float;
+    }
+}
+
+double variantToNumber(const QVariant& value)
+{
+    switch (value.type()) {
+    case QVariant::Date:
+        return QDateTime(value.toDate()).toMSecsSinceEpoch();
+    case QVariant::DateTime:
+        return value.toDateTime().toMSecsSinceEpoch();
+    case QVariant::Time:
+        return QTime(0,0).msecsTo(value.toTime());
+    default:
+        return value.toDouble();
+    }
+}
+
+QDateTime textToDateTime(const QString& text)
+{
+    QDateTime result = QDateTime::fromString(text, Qt::ISODate);
+    if (!result.isValid()){
+        QDate date = QDate::fromString(text, Qt::ISODate);
+        if (date.isValid()) result = QDateTime(date);
+    }
+    return result;
+}
+
+bool convertToNumber(const QVariant& value, SortKey::KeyType type, double& number)
+{
+    if (isNumericVariant(value)){
+        number = variantToNumber(value);
+        return true;
+    }
+    QString text = value.toString().trimmed();
+    if (type == SortKey::DateKey){
+        QDateTime dateTime = textToDateTime(text);
+        if (dateTime.isValid()) number = dateTime.toMSecsSinceEpoch();
+        return dateTime.isValid();
+    }
+    bool ok = false;
+    number = text.toDouble(&ok);
+    return ok;
+}
+
+SortKey::KeyType detectKeyType(const QVector<QVariant>& values, const QBitArray& nulls)
+{
+    bool numbers = true;
+    bool dates = true;
+    for (int i = 0; i < values.size() && (numbers || dates); ++i){
+        const QVariant& value = values.at(i);
+        if (nulls.testBit(i) || isNumericVariant(value)) continue;
+        QString text = value.toString().trimmed();
+        if (numbers) text.toDouble(&numbers);
+        if (dates) dates = textToDateTime(text).isValid();
+    }
+    if (numbers) return SortKey::NumberKey;
+    return dates ? SortKey::DateKey : SortKey::StringKey;
+}
+
+void fillSortKey(SortKey& key, const QVector<QVariant>& values)
+{
+    key.nulls.resize(values.size());
+    for (int i = 0; i < values.size(); ++i){
+        const QVariant& value = values.at(i);
+        if (!value.isValid() || value.isNull())
+            key.nulls.setBit(i);
+    }
+    if (key.type == SortKey::AutoKey)
+        key.type = detectKeyType(values, key.nulls);
+    if (key.type != SortKey::StringKey){
+        key.numbers.resize(values.size());
+        for (int i = 0; i < values.size(); ++i){
+            if (!key.nulls.testBit(i) && !convertToNumber(values.at(i), key.type, key.numbers[i]))
+                key.nulls.setBit(i);
+        }
+    } else {
+        key.strings.resize(values.size());
+        for (int i = 0; i < values.size(); ++i)
+            if (!key.nulls.testBit(i)) key.strings[i] = values.at(i).toString();
+    }
+}
+
+class RowLessThan{
+public:
+    explicit RowLessThan(const QVector<SortKey>* keys):m_keys(keys){}
+    bool operator()(int a, int b) const
+    {
+        for (int i = 0; i < m_keys->size(); ++i){
+            const SortKey& key = m_keys->at(i);
+            int result = compare(key, a, b);
+            if (result != 0) return key.descending ? result > 0 : result < 0;
+        }
+        return false;
+    }
+private:
+    int compare(const SortKey& key, int a, int b) const
+    {
+        bool nullA = key.nulls.testBit(a);
+        bool nullB = key.nulls.testBit(b);
+        if (nullA || nullB) return nullA == nullB ? 0 : (nullA ? -1 : 1);
+        if (key.type != SortKey::StringKey){
+            double x = key.numbers.at(a);
+            double y = key.numbers.at(b);
+            return x < y ? -1 : (y < x ? 1 : 0);
+        }
+        return key.strings.at(a).compare(key.strings.at(b));
+    }
+    const QVector<SortKey>* m_keys;
+};
+
+class SortRangeTask : public QRunnable{
+public:
+    SortRangeTask(int* begin, int* middle, int* end, const RowLessThan& lessThan)
+        :m_begin(begin), m_middle(middle), m_end(end), m_lessThan(lessThan){}
+    void run()
+    {
+        if (m_middle)
+            std::inplace_merge(m_begin, m_middle, m_end, m_lessThan);
+        else
+            std::stable_sort(m_begin, m_end, m_lessThan);
+    }
+private:
+    int* m_begin;
+    int* m_middle;
+    int* m_end;
+    RowLessThan m_lessThan;
+};
+
+void parallelStableSort(QVector<int>& rows, const RowLessThan& lessThan)
+{
+    int threads = QThread::idealThreadCount();
+    if (rows.size() < Const::SORT_PARALLEL_THRESHOLD || threads < 2){
+        std::stable_sort(rows.begin(), rows.end(), lessThan);
+        return;
+    }
+
+    int* data = rows.data();
+    QVector<int> bounds;
+    for (int i = 0; i < threads; ++i)
+        bounds.append(int(qint64(rows.size()) * i / threads));
+    bounds.append(rows.size());
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int i = 0; i + 1 < bounds.size(); ++i)
+        pool.start(new SortRangeTask(data + bounds.at(i), 0, data + bounds.at(i+1), lessThan));
+    pool.waitForDone();
+
+    // merging neighbouring runs keeps the sort stable
+    while (bounds.size() > 2){
+        QVector<int> merged;
+        int i = 0;
+        for (; i + 2 < bounds.size(); i += 2){
+            pool.start(new SortRangeTask(data + bounds.at(i), data + bounds.at(i+1), data + bounds.at(i+2), lessThan));
+            merged.append(bounds.at(i));
+        }
+        for (; i < bounds.size(); ++i)
+            merged.append(bounds.at(i));
+        pool.waitForDone();
+        bounds = merged;
+    }
+}
+
+} // namespace
+
+SortedDataSource::SortedDataSource(IDataSource *source, const QString &sortBy)
+    : m_source(source), m_sortBy(sortBy), m_curRow(-1)
+{
+    sort(sortBy);
+    first();
+}
+
+void SortedDataSource::setSource(IDataSource *source)
+{
+    m_source = source;
+    m_rows.clear();
+    m_lastError.clear();
+    sort(m_sortBy);
+    first();
+}
+
+void SortedDataSource::sort(const QString &sortBy)
+{
+    if (!m_source) return;
+    QStringList fields;
+    QVector<SortKey> keys;
+    foreach(QString item, sortBy.split(',', QString::SkipEmptyParts)){
+        QStringList parts = item.trimmed().split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        if (parts.isEmpty()) continue;
+        SortKey key;
+        QString field = parts.at(0);
+        int typePos = field.lastIndexOf(':');
+        if (typePos != -1){
+            QString type = field.mid(typePos + 1).toLower();
+            field.truncate(typePos);
+            if (type == "number") key.type = SortKey::NumberKey;
+            else if (type == "date") key.type = SortKey::DateKey;
+            else if (type == "string") key.type = SortKey::StringKey;
+            else {
+                m_lastError = QObject::tr("Unknown sort type \"%1\" of field \"%2\"").arg(type).arg(field);
+                continue;
+            }
+        }
+        if (m_source->columnIndexByName(field) == -1){
+            m_lastError = QObject::tr("Sort field \"%1\" not found").arg(field);
+            continue;
+        }
+        key.descending = parts.count() > 1 && parts.at(1).compare("desc", Qt::CaseInsensitive) == 0;
+        fields.append(field);
+        keys.append(key);
+    }
+
+    QVector< QVector<QVariant> > values(fields.count());
+    m_source->first();
+    while (!m_source->eof()){
+        for (int i = 0; i < fields.count(); ++i)
+            values[i].append(m_source->data(fields.at(i)));
+        m_rows.append(m_rows.size());
+        m_source->next();
+    }
+    m_source->first();
+
+    if (keys.isEmpty() || m_rows.size() < 2) return;
+    for (int i = 0; i < keys.count(); ++i){
+        fillSortKey(keys[i], values.at(i));
+        values[i].clear();
+    }
+    parallelStableSort(m_rows, RowLessThan(&keys));
+}
+
+int SortedDataSource::currentRow()
+{
+    if (eof()) return m_curRow-1;
+    if (bof()) return m_curRow+1;
+    return m_curRow;
+}
+
+bool SortedDataSource::next()
+{
+    if (m_curRow < m_rows.size()){
+        if (bof()) m_curRow++;
+        m_curRow++;
+        return true;
+    } else return false;
+}
+
+bool SortedDataSource::hasNext()
+{
+    return m_curRow < m_rows.size()-1;
+}
+
+bool SortedDataSource::prior()
+{
+    if (m_curRow > -1){
+        if (eof()) m_curRow--;
+        m_curRow--;
+        return true;
+    } else return false;
+}
+
+void SortedDataSource::first()
+{
+    m_curRow = 0;
+}
+
+void SortedDataSource::last()
+{
+    m_curRow = m_rows.size()-1;
+}
+
+bool SortedDataSource::bof()
+{
+    return (m_curRow == -1) || m_rows.isEmpty();
+}
+
+bool SortedDataSource::eof()
+{
+    return (m_curRow == m_rows.size()) || m_rows.isEmpty();
+}
+
+QVariant SortedDataSource::data(const QString &columnName)
+{
+    return dataByRowIndex(columnName, currentRow());
+}
+
+QVariant SortedDataSource::dataByRowIndex(const QString &columnName, int rowIndex)
+{
+    if (!m_source || rowIndex < 0 || rowIndex >= m_rows.size()) return QVariant();
+    return m_source->dataByRowIndex(columnName, m_rows.at(rowIndex));
+}
+
+QVariant SortedDataSource::dataByKeyField(const QString &columnName, const QString &keyColumnName, QVariant keyData)
+{
+    return m_source ? m_source->dataByKeyField(columnName, keyColumnName, keyData) : QVariant();
+}
+
+int SortedDataSource::columnCount()
+{
+    return m_source ? m_source->columnCount() : 0;
+}
+
+QString SortedDataSource::columnNameByIndex(int columnIndex)
+{
+    return m_source ? m_source->columnNameByIndex(columnIndex) : QString();
+}
+
+int SortedDataSource::columnIndexByName(QString name)
+{
+    return m_source ? m_source->columnIndexByName(name) : -1;
+}
+
+bool SortedDataSource::isInvalid() const
+{
+    return !m_source || m_source->isInvalid();
+}
+
+QString SortedDataSource::lastError()
+{
+    return m_lastError.isEmpty() && m_source ? m_source->lastError() : m_lastError;
+}
+
+QAbstractItemModel *SortedDataSource::model()
+{
+    return m_source ? m_source->model() : 0;
+}
+
+} // namespace LimeReport
@@ -0,0 +1,55 @@
+#ifndef LRSORTEDDATASOURCE_H
+#define LRSORTEDDATASOURCE_H
+
+#include <QVector>
+#include <QStringList>
+#include "lrdatasourceintf.h"
+
+namespace LimeReport{
+
+// Ordered view of another datasource. Only the sort key columns are read once,
+// the rows themselves stay in the source and are reached through a row-index
+// permutation produced by a stable multi-key sort.
+class SortedDataSource : public IDataSource{
+public:
+    // sortBy: comma separated list of "field[:number|date|string] [asc|desc]".
+    // Without a type hint a key compares as numbers or dates when all of its
+    // values are, or are text convertible to, numbers or ISO dates; otherwise as
+    // strings. Nulls, and values a hinted key cannot convert, go first in
+    // ascending order and last in descending order.
+    SortedDataSource(IDataSource* source, const QString& sortBy);
+    IDataSource* source() const { return m_source; }
+    // Re-sorts over a new source, e.g. after the query behind it was reopened;
+    // 0 leaves the view empty.
+    void setSource(IDataSource* source);
+    bool next();
+    bool hasNext();
+    bool prior();
+    void first();
+    void last();
+    bool bof();
+    bool eof();
+    QVariant data(const QString& columnName);
+    QVariant dataByRowIndex(const QString& columnName, int rowIndex);
+    QVariant dataByKeyField(const QString& columnName, const QString& keyColumnName, QVariant keyData);
+    int columnCount();
+    QString columnNameByIndex(int columnIndex);
+    int columnIndexByName(QString name);
+    bool isInvalid() const;
+    QString lastError();
+    QAbstractItemModel* model();
+    int rowCount() const { return m_rows.size(); }
+    int currentRow();
+private:
+    void sort(const QString& sortBy);
+private:
+    IDataSource* m_source;
+    QString m_sortBy;
+    QVector<int> m_rows;
+    int m_curRow;
+    QString m_lastError;
+};
+
+} // namespace LimeReport
+
+#endif // LRSORTEDDATASOURCE_H
@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   This file is part of the Lime Report project                          *
+ *   Copyright (C) 2015 by Alexander Arin                                  *
+ *   arin_a@bk.ru                                                          *
+ *                                                                         *
+ **                   GNU General Public License Usage                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ **                  GNU Lesser General Public License                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation, either version 3 of the    *
+ *   License, or (at your option) any later version.                       *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library.                                      *
+ *   If not, see <http://www.gnu.org/licenses/>.                           *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ****************************************************************************/
+#include "lrtemplatecache.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+namespace LimeReport {
+
+CachedTemplate::Ptr TemplateCache::acquire(const QString& fileName, QString* error)
+{
+    QFileInfo fileInfo(fileName);
+    if (!fileInfo.exists()){
+        if (error) *error = QObject::tr("File %1 not opened").arg(fileName);
+        return CachedTemplate::Ptr();
+    }
+    QString key = fileInfo.absoluteFilePath();
+
+    QMutexLocker locker(&m_mutex);
+    CachedTemplate::Ptr cachedTemplate = m_templates.value(key);
+    if (cachedTemplate){
+        if (isActual(cachedTemplate, fileInfo)){
+            m_statistics.hits++;
+            return cachedTemplate;
+        }
+        m_templates.remove(key);
+        m_statistics.reloads++;
+    }
+    m_statistics.misses++;
+    locker.unlock();
+
+    // parsing is the expensive part, other templates stay available meanwhile
+    cachedTemplate = loadTemplate(fileInfo, error);
+    if (!cachedTemplate) return cachedTemplate;
+
+    locker.relock();
+    CachedTemplate::Ptr loadedByOther = m_templates.value(key);
+    if (loadedByOther && isActual(loadedByOther, fileInfo))
+        return loadedByOther;
+    m_templates.insert(key, cachedTemplate);
+    return cachedTemplate;
+}
+
+void TemplateCache::remove(const QString& fileName)
+{
+    QMutexLocker locker(&m_mutex);
+    m_templates.remove(QFileInfo(fileName).absoluteFilePath());
+}
+
+void TemplateCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_templates.clear();
+    m_statistics = TemplateCacheStatistics();
+}
+
+TemplateCacheStatistics TemplateCache::statistics()
+{
+    QMutexLocker locker(&m_mutex);
+    TemplateCacheStatistics result = m_statistics;
+    result.size = m_templates.size();
+    return result;
+}
+
+bool TemplateCache::isActual(CachedTemplate::Ptr cachedTemplate, const QFileInfo& fileInfo)
+{
+    return cachedTemplate->lastModified == fileInfo.lastModified() &&
+           cachedTemplate->fileSize == fileInfo.size();
+}
+
+CachedTemplate::Ptr TemplateCache::loadTemplate(const QFileInfo& fileInfo, QString* error)
+{
+    QFile source(fileInfo.absoluteFilePath());
+    if (!source.open(QFile::ReadOnly)){
+        if (error) *error = QObject::tr("File %1 not opened").arg(fileInfo.filePath());
+        return CachedTemplate::Ptr();
+    }
+
+    CachedTemplate::Ptr result(new CachedTemplate);
+    result->fileName = fileInfo.absoluteFilePath();
+    result->lastModified = fileInfo.lastModified();
+    result->fileSize = fileInfo.size();
+    result->document = QSharedPointer<QDomDocument>(new QDomDocument);
+
+    QString parseError;
+    int errorLine = 0;
+    if (!result->document->setContent(&source, &parseError, &errorLine)){
+        if (error) *error = QObject::tr("Wrong file format") + QString(": %1 (%2)").arg(parseError).arg(errorLine);
+        return CachedTemplate::Ptr();
+    }
+    if (result->document->documentElement().nodeName() != "Report"){
+        if (error) *error = QObject::tr("Wrong file format");
+        return CachedTemplate::Ptr();
+    }
+
+    result->skeleton = QSharedPointer<QDomDocument>(new QDomDocument(result->document->cloneNode(true).toDocument()));
+    QDomElement reportObject = result->skeleton->documentElement().firstChildElement();
+    QDomElement pages = reportObject.firstChildElement("pages");
+    if (!pages.isNull())
+        reportObject.removeChild(pages);
+    return result;
+}
+
+} // namespace LimeReport
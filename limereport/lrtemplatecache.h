@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   This file is part of the Lime Report project                          *
+ *   Copyright (C) 2015 by Alexander Arin                                  *
+ *   arin_a@bk.ru                                                          *
+ *                                                                         *
+ **                   GNU General Public License Usage                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ **                  GNU Lesser General Public License                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation, either version 3 of the    *
+ *   License, or (at your option) any later version.                       *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library.                                      *
+ *   If not, see <http://www.gnu.org/licenses/>.                           *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ****************************************************************************/
+#ifndef LRTEMPLATECACHE_H
+#define LRTEMPLATECACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSharedPointer>
+#include <QtXml>
+
+#include "lrsingleton.h"
+#include "lrreportengine.h"
+#include "lrpageitemdesignintf.h"
+
+namespace LimeReport {
+
+struct CachedPage{
+    QString name;
+    QVariantMap properties;
+    PageItemDesignIntf::Ptr prototype;
+};
+
+struct CachedTemplate{
+    typedef QSharedPointer<CachedTemplate> Ptr;
+    CachedTemplate(): fileSize(0), pagesBuilt(false){}
+    QString fileName;
+    QDateTime lastModified;
+    qint64 fileSize;
+    // the parsed documents are never modified after they have been cached,
+    // readers only need to be serialized because QDomDocument is not reentrant
+    QSharedPointer<QDomDocument> document;
+    // document without the pages collection, read when the pages are cloned
+    QSharedPointer<QDomDocument> skeleton;
+    // page prototypes built by the first load in the application thread, guarded
+    // by readLock; loads in other threads never build or clone them
+    QList<CachedPage> pages;
+    bool pagesBuilt;
+    QMutex readLock;
+};
+
+class TemplateCache : public Singleton<TemplateCache>{
+public:
+    CachedTemplate::Ptr acquire(const QString& fileName, QString* error = 0);
+    void remove(const QString& fileName);
+    void clear();
+    TemplateCacheStatistics statistics();
+private:
+    friend class Singleton<TemplateCache>;
+    TemplateCache(){}
+    ~TemplateCache(){}
+    TemplateCache(const TemplateCache&){}
+    TemplateCache& operator = (const TemplateCache&){return *this;}
+    bool isActual(CachedTemplate::Ptr cachedTemplate, const QFileInfo& fileInfo);
+    CachedTemplate::Ptr loadTemplate(const QFileInfo& fileInfo, QString* error);
+private:
+    QHash<QString, CachedTemplate::Ptr> m_templates;
+    TemplateCacheStatistics m_statistics;
+    QMutex m_mutex;
+};
+
+} // namespace LimeReport
+
+#endif // LRTEMPLATECACHE_H
@@ -35,17 +35,13 @@
 namespace LimeReport{
 
 VariablesHolder::VariablesHolder(QObject *parent) :
-    QObject(parent)
+    QObject(parent), m_namesCacheValid(false)
 {
 }
 
 VariablesHolder::~VariablesHolder()
 {
-    QMap<QString,VarDesc*>::iterator it = m_varNames.begin();
-    while(it!=m_varNames.end()){
-        delete *it;
-        ++it;
-    }
+    qDeleteAll(m_varNames);
     m_varNames.clear();
     m_userVariables.clear();
 }
@@ -61,6 +57,7 @@ void VariablesHolder::addVariable(const QString& name, const QVariant& value, Va
         m_varNames.insert(name,varValue);
         if (type==VarDesc::Report)
             m_userVariables.append(varValue);
+        m_namesCacheValid = false;
         emit variableHasBeenAdded(name);
     } else {
         throw ReportError(tr("variable with name ")+name+tr(" already exists!"));
@@ -69,32 +66,33 @@ void VariablesHolder::addVariable(const QString& name, const QVariant& value, Va
 
 QVariant VariablesHolder::variable(const QString &name)
 {
-    if (m_varNames.contains(name))
-        return m_varNames.value(name)->value();
-    else return QVariant();
+    VarDesc* var = m_varNames.value(name, 0);
+    return var ? var->value() : QVariant();
 }
 
 VarDesc::VarType VariablesHolder::variableType(const QString &name)
 {
-    if (m_varNames.contains(name))
-        return m_varNames.value(name)->varType();
+    VarDesc* var = m_varNames.value(name, 0);
+    if (var) return var->varType();
     else throw ReportError(tr("variable with name ")+name+tr(" does not exists!"));
 }
 
 void VariablesHolder::deleteVariable(const QString &name)
 {
-    if (m_varNames.contains(name)) {
-        m_userVariables.removeOne(m_varNames.value(name));
-        delete m_varNames.value(name);
-        m_varNames.remove(name);
+    VarDesc* var = m_varNames.take(name);
+    if (var) {
+        m_userVariables.removeOne(var);
+        delete var;
+        m_namesCacheValid = false;
         emit variableHasBennDeleted(name);
     }
 }
 
 void VariablesHolder::changeVariable(const QString &name, const QVariant &value)
 {
-    if(m_varNames.contains(name)) {
-        m_varNames.value(name)->setValue(value);
+    VarDesc* var = m_varNames.value(name, 0);
+    if(var) {
+        var->setValue(value);
         emit variableHasBeenChanged(name);
     } else
         throw ReportError(tr("variable with name ")+name+tr(" does not exists!"));
@@ -102,13 +100,14 @@ void VariablesHolder::changeVariable(const QString &name, const QVariant &value)
 
 void VariablesHolder::clearUserVariables()
 {
-    QMap<QString,VarDesc*>::iterator it = m_varNames.begin();
+    QHash<QString,VarDesc*>::iterator it = m_varNames.begin();
     while (it != m_varNames.end()){
         if (it.value()->varType()==VarDesc::User ||
             it.value()->varType()==VarDesc::Report){
             m_userVariables.removeAll(it.value());
             delete it.value();
             it = m_varNames.erase(it);
+            m_namesCacheValid = false;
         } else {
             ++it;
         }
@@ -129,9 +128,7 @@ int VariablesHolder::variablesCount()
 
 VarDesc* VariablesHolder::variableByName(const QString& name)
 {
-    if (m_varNames.contains(name))
-        return m_varNames.value(name);
-    else return 0;
+    return m_varNames.value(name, 0);
 }
 
 VarDesc *VariablesHolder::variableAt(int index)
@@ -141,44 +138,59 @@ VarDesc *VariablesHolder::variableAt(int index)
 
 bool VariablesHolder::variableIsMandatory(const QString& name)
 {
-    if (m_varNames.contains(name))
-        return m_varNames.value(name)->isMandatory();
-    else return false;
+    VarDesc* var = m_varNames.value(name, 0);
+    return var ? var->isMandatory() : false;
 }
 
 void VariablesHolder::setVarableMandatory(const QString& name, bool value)
 {
-    if (m_varNames.contains(name))
-        m_varNames.value(name)->setMandatory(value);
-
+    VarDesc* var = m_varNames.value(name, 0);
+    if (var) var->setMandatory(value);
 }
 
 VariableDataType VariablesHolder::variableDataType(const QString& name)
 {
-    if (m_varNames.contains(name))
-        return m_varNames.value(name)->dataType();
-    else return Enums::Undefined;
+    VarDesc* var = m_varNames.value(name, 0);
+    return var ? var->dataType() : Enums::Undefined;
 }
 
 void VariablesHolder::setVariableDataType(const QString& name, VariableDataType value)
 {
-    if (m_varNames.contains(name))
-        m_varNames.value(name)->setDataType(value);
+    VarDesc* var = m_varNames.value(name, 0);
+    if (var) var->setDataType(value);
 }
 
-QStringList VariablesHolder::variableNames()
+void VariablesHolder::updateNamesCache()
 {
-    QStringList result;
-    foreach(QString varName,m_varNames.keys()){
-        result<<varName;
+    m_sortedNames = m_varNames.keys();
+    m_sortedNames.sort();
+    m_firstPassNames.clear();
+    m_secondPassNames.clear();
+    foreach(QString varName, m_sortedNames){
+        if (m_varNames.value(varName)->renderPass() == SecondPass)
+            m_secondPassNames.append(varName);
+        else
+            m_firstPassNames.append(varName);
     }
-    return result;
+    m_namesCacheValid = true;
+}
+
+QStringList VariablesHolder::variableNames()
+{
+    if (!m_namesCacheValid) updateNamesCache();
+    return m_sortedNames;
+}
+
+const QStringList& VariablesHolder::variableNamesByRenderPass(RenderPass pass)
+{
+    if (!m_namesCacheValid) updateNamesCache();
+    return (pass == SecondPass) ? m_secondPassNames : m_firstPassNames;
 }
 
 RenderPass VariablesHolder::variablePass(const QString &name)
 {
-    if (m_varNames.contains(name))
-        return m_varNames.value(name)->renderPass();
+    VarDesc* var = m_varNames.value(name, 0);
+    if (var) return var->renderPass();
     else throw ReportError(tr("variable with name ")+name+tr(" does not exists!"));
 }
 
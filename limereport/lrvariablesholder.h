@@ -31,8 +31,9 @@
 #define LRVARIABLEHOLDER_H
 
 #include <QObject>
-#include <QMap>
+#include <QHash>
 #include <QVector>
+#include <QStringList>
 #include <QVariant>
 #include "lrglobal.h"
 
@@ -112,13 +113,20 @@ public:
     void     setVarableMandatory(const QString &name, bool value);
     VariableDataType variableDataType(const QString& name);
     void setVariableDataType(const QString &name, VariableDataType value);
+    const QStringList& variableNamesByRenderPass(RenderPass pass);
 signals:
     void variableHasBeenAdded(const QString& variableName);
     void variableHasBeenChanged(const QString& variableName);
     void variableHasBennDeleted(const QString& variableName);
 private:
-    QMap<QString,VarDesc*> m_varNames;
+    void updateNamesCache();
+private:
+    QHash<QString,VarDesc*> m_varNames;
     QList<VarDesc*> m_userVariables;
+    bool m_namesCacheValid;
+    QStringList m_sortedNames;
+    QStringList m_firstPassNames;
+    QStringList m_secondPassNames;
 };
 
 }// namespace LimeReport
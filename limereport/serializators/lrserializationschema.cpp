@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   This file is part of the Lime Report project                          *
+ *   Copyright (C) 2015 by Alexander Arin                                  *
+ *   arin_a@bk.ru                                                          *
+ *                                                                         *
+ **                   GNU General Public License Usage                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ **                  GNU Lesser General Public License                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation, either version 3 of the    *
+ *   License, or (at your option) any later version.                       *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library.                                      *
+ *   If not, see <http://www.gnu.org/licenses/>.                           *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ****************************************************************************/
+#include "lrserializationschema.h"
+#include "lrbasedesignintf.h"
+#include "lrdesignelementsfactory.h"
+#include "lrcollection.h"
+#include "lrreporttranslation.h"
+
+namespace LimeReport{
+
+namespace {
+// These properties are initialized from the parent item or the owner,
+// so a value taken from a standalone prototype can not be trusted.
+bool isContextDependent(const QByteArray& name){
+    return name == "objectName" || name == "geometry" || name == "font";
+}
+}
+
+const SchemaPropertyDesc* SerializationSchema::property(const QByteArray& name) const
+{
+    QHash<QByteArray, int>::const_iterator it = m_propertyIndex.constFind(name);
+    if (it != m_propertyIndex.constEnd())
+        return &m_properties.at(it.value());
+    return 0;
+}
+
+bool SerializationSchema::isDefaultValue(const SchemaPropertyDesc& desc, const QVariant& value) const
+{
+    return desc.hasDefaultValue && value == desc.defaultValue;
+}
+
+SerializationSchemaCache::~SerializationSchemaCache()
+{
+    qDeleteAll(m_schemas);
+    qDeleteAll(m_replacedSchemas);
+}
+
+const SerializationSchema* SerializationSchemaCache::schema(QObject* object)
+{
+    const QMetaObject* metaObject = object->metaObject();
+    int itemTypesCount = DesignElementsFactory::instance().mapElementCount();
+    QMutexLocker locker(&m_mutex);
+    SerializationSchema* cached = m_schemas.value(metaObject);
+    if (cached && isActual(cached, itemTypesCount))
+        return cached;
+    locker.unlock();
+
+    // the default values prototype is built without the lock,
+    // its constructor can create and save other items
+    SerializationSchema* result = createSchema(object, itemTypesCount);
+
+    locker.relock();
+    SerializationSchema* current = m_schemas.value(metaObject);
+    if (current != cached && isActual(current, itemTypesCount)){
+        delete result;
+        return current;
+    }
+    if (current)
+        m_replacedSchemas.append(current);
+    m_schemas.insert(metaObject, result);
+    return result;
+}
+
+bool SerializationSchemaCache::isActual(const SerializationSchema* schema, int itemTypesCount) const
+{
+    return schema && (schema->m_defaultsResolved || schema->m_itemTypesCount == itemTypesCount);
+}
+
+CreateSerializator SerializationSchemaCache::serializatorCreator(const QString& typeName)
+{
+    return XMLAbstractSerializatorFactory::instance().objectCreator(typeName);
+}
+
+SerializationSchema* SerializationSchemaCache::createSchema(QObject* object, int itemTypesCount)
+{
+    const QMetaObject* metaObject = object->metaObject();
+    SerializationSchema* schema = new SerializationSchema();
+    schema->m_itemTypesCount = itemTypesCount;
+    schema->m_properties.reserve(metaObject->propertyCount());
+    for (int i = 0; i < metaObject->propertyCount(); ++i){
+        SchemaPropertyDesc desc;
+        desc.metaProperty = metaObject->property(i);
+        desc.name = desc.metaProperty.name();
+        desc.typeName = desc.metaProperty.typeName();
+        int typeId = QMetaType::type(desc.metaProperty.typeName());
+        if (typeId == COLLECTION_TYPE_ID){
+            desc.kind = SchemaPropertyDesc::Collection;
+        } else if (typeId == TRANSLATION_TYPE_ID){
+            desc.kind = SchemaPropertyDesc::Translation;
+        } else if (typeId == QMetaType::QObjectStar){
+            desc.kind = SchemaPropertyDesc::ChildObject;
+        } else if (desc.metaProperty.isEnumType() || desc.metaProperty.isFlagType()){
+            desc.kind = SchemaPropertyDesc::EnumOrFlag;
+            desc.serializatorType = "enumAndFlags";
+        } else if (typeId == QMetaType::QVariant){
+            // the serializator depends on the type of the stored value
+            desc.kind = SchemaPropertyDesc::Variant;
+        } else {
+            desc.serializatorType = desc.typeName;
+        }
+        schema->m_propertyIndex.insert(desc.name, schema->m_properties.size());
+        schema->m_properties.append(desc);
+    }
+    fillDefaultValues(schema, object);
+    return schema;
+}
+
+void SerializationSchemaCache::fillDefaultValues(SerializationSchema* schema, QObject* object)
+{
+    BaseDesignIntf* item = dynamic_cast<BaseDesignIntf*>(object);
+    if (!item) return;
+    CreateBand creator = DesignElementsFactory::instance().objectCreator(item->storageTypeName());
+    if (!creator){
+        // retried once another item type has been registered
+        schema->m_defaultsResolved = false;
+        return;
+    }
+    QScopedPointer<BaseDesignIntf> prototype(creator(0, 0));
+    if (!prototype || prototype->metaObject() != object->metaObject()) return;
+    for (int i = 0; i < schema->m_properties.size(); ++i){
+        SchemaPropertyDesc& desc = schema->m_properties[i];
+        if ((desc.kind == SchemaPropertyDesc::Simple || desc.kind == SchemaPropertyDesc::EnumOrFlag) &&
+             !isContextDependent(desc.name))
+        {
+            desc.defaultValue = desc.metaProperty.read(prototype.data());
+            desc.hasDefaultValue = desc.defaultValue.isValid();
+        }
+    }
+}
+
+} // namespace LimeReport
@@ -0,0 +1,96 @@
+/***************************************************************************
+ *   This file is part of the Lime Report project                          *
+ *   Copyright (C) 2015 by Alexander Arin                                  *
+ *   arin_a@bk.ru                                                          *
+ *                                                                         *
+ **                   GNU General Public License Usage                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ **                  GNU Lesser General Public License                    **
+ *                                                                         *
+ *   This library is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Lesser General Public License as        *
+ *   published by the Free Software Foundation, either version 3 of the    *
+ *   License, or (at your option) any later version.                       *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library.                                      *
+ *   If not, see <http://www.gnu.org/licenses/>.                           *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ ****************************************************************************/
+#ifndef LRSERIALIZATIONSCHEMA_H
+#define LRSERIALIZATIONSCHEMA_H
+
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QMetaProperty>
+#include <QVariant>
+
+#include "lrsingleton.h"
+#include "serializators/lrxmlserializatorsfactory.h"
+
+namespace LimeReport{
+
+struct SchemaPropertyDesc{
+    enum Kind {Simple, EnumOrFlag, Variant, Collection, Translation, ChildObject};
+    SchemaPropertyDesc()
+        : kind(Simple), hasDefaultValue(false){}
+    QMetaProperty metaProperty;
+    QByteArray name;
+    QString typeName;
+    Kind kind;
+    // serializators are looked up when used, plugins can register them later
+    QString serializatorType;
+    bool hasDefaultValue;
+    QVariant defaultValue;
+};
+
+class SerializationSchema{
+public:
+    SerializationSchema(): m_defaultsResolved(true), m_itemTypesCount(0){}
+    const QVector<SchemaPropertyDesc>& properties() const {return m_properties;}
+    const SchemaPropertyDesc* property(const QByteArray& name) const;
+    bool isDefaultValue(const SchemaPropertyDesc& desc, const QVariant& value) const;
+private:
+    friend class SerializationSchemaCache;
+    QVector<SchemaPropertyDesc> m_properties;
+    QHash<QByteArray, int> m_propertyIndex;
+    // false while the item type has no registered creator to take defaults from
+    bool m_defaultsResolved;
+    int m_itemTypesCount;
+};
+
+class SerializationSchemaCache : public Singleton<SerializationSchemaCache>
+{
+public:
+    const SerializationSchema* schema(QObject* object);
+    CreateSerializator serializatorCreator(const QString& typeName);
+private:
+    friend class Singleton<SerializationSchemaCache>;
+    SerializationSchemaCache(){}
+    ~SerializationSchemaCache();
+    SerializationSchemaCache(const SerializationSchemaCache&){}
+    SerializationSchemaCache& operator = (const SerializationSchemaCache&){return *this;}
+    bool isActual(const SerializationSchema* schema, int itemTypesCount) const;
+    SerializationSchema* createSchema(QObject* object, int itemTypesCount);
+    void fillDefaultValues(SerializationSchema* schema, QObject* object);
+private:
+    QHash<const QMetaObject*, SerializationSchema*> m_schemas;
+    // replaced schemas can still be in use by other threads
+    QList<SerializationSchema*> m_replacedSchemas;
+    QMutex m_mutex;
+};
+
+} // namespace LimeReport
+
+#endif // LRSERIALIZATIONSCHEMA_H
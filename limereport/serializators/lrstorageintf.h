@@ -52,6 +52,7 @@ public:
     virtual QString saveToString() = 0;
     virtual QByteArray saveToByteArray() = 0;
     virtual void setPassPhrase(const QString& passPhrase) = 0;
+    virtual void setSkipDefaultValues(bool value) = 0;
     virtual ~ItemsWriterIntf(){}
 };
 
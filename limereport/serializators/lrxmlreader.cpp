@@ -117,16 +117,19 @@ void XMLReader::readItemFromNode(QObject* item,QDomElement *node)
     EASY_BLOCK("readItemFromNode");
     ObjectLoadingStateIntf* lf = dynamic_cast<ObjectLoadingStateIntf*>(item);
     if(lf) lf->objectLoadStarted();
+    const SerializationSchema* schema = SerializationSchemaCache::instance().schema(item);
     for (int i=0;i<node->childNodes().count();i++){
         QDomElement currentNode =node->childNodes().at(i).toElement();
-        if (currentNode.attribute("Type")=="Object"){
-            readQObject(item,&currentNode);
-        } else if (currentNode.attribute("Type")=="Collection")
+        QString type = currentNode.attribute("Type");
+        const SchemaPropertyDesc* desc = schema->property(currentNode.nodeName().toLatin1());
+        if (type=="Object"){
+            readQObject(item,&currentNode,desc);
+        } else if (type=="Collection")
         {
             readCollection(item,&currentNode);
-        } else if (currentNode.attribute("Type")=="Translation"){
+        } else if (type=="Translation"){
             readTranslation(item,&currentNode);
-        } else readProperty(item,&currentNode);
+        } else readProperty(item,&currentNode,desc);
     }
     if (lf) lf->objectLoadFinished();
 
@@ -163,21 +166,17 @@ bool XMLReader::extractFirstNode()
     return !m_firstNode.isNull();
 }
 
-void XMLReader::readProperty(QObject *item, QDomElement *node)
+void XMLReader::readProperty(QObject *item, QDomElement *node, const SchemaPropertyDesc* desc)
 {
-    item->setProperty(node->nodeName().toLatin1(),getValue(node));
+    if (desc)
+        desc->metaProperty.write(item, getValue(node));
+    else
+        item->setProperty(node->nodeName().toLatin1(),getValue(node));
 }
 
 QVariant XMLReader::getValue(QDomElement *node)
 {
-    CreateSerializator creator = 0;
-    try {
-        creator=XMLAbstractSerializatorFactory::instance().objectCreator(
-                node->attribute("Type")
-                );
-    } catch(ReportError &e){
-        qDebug()<<node->attribute("Type")<<e.what();
-    }
+    CreateSerializator creator = SerializationSchemaCache::instance().serializatorCreator(node->attribute("Type"));
 
     if (creator) {
         QScopedPointer<SerializatorIntf>serializator(creator(m_doc.data(),node));
@@ -190,10 +189,11 @@ QVariant XMLReader::getValue(QDomElement *node)
     return QVariant();
 }
 
-void XMLReader::readQObject(QObject* item, QDomElement* node)
+void XMLReader::readQObject(QObject* item, QDomElement* node, const SchemaPropertyDesc* desc)
 {
     EASY_BLOCK("readQObject");
-    QObject* childItem = qvariant_cast<QObject*>(item->property(node->nodeName().toLatin1()));
+    QObject* childItem = desc ? qvariant_cast<QObject*>(desc->metaProperty.read(item))
+                              : qvariant_cast<QObject*>(item->property(node->nodeName().toLatin1()));
     if (childItem)
         readItemFromNode(childItem,node);
     EASY_END_BLOCK;
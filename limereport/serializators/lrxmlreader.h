@@ -58,8 +58,8 @@ protected:
     virtual bool prepareReader(QDomDocument *doc);
 
     void readItemFromNode(QObject *item, QDomElement *node);
-    void readProperty(QObject *item, QDomElement *node);
-    void readQObject(QObject *item, QDomElement *node);
+    void readProperty(QObject *item, QDomElement *node, const SchemaPropertyDesc* desc = 0);
+    void readQObject(QObject *item, QDomElement *node, const SchemaPropertyDesc* desc = 0);
     void readCollection(QObject *item, QDomElement *node);
     void readTranslation(QObject *item, QDomElement *node);
     QVariant getValue(QDomElement *node);
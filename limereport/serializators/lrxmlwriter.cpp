@@ -32,16 +32,17 @@
 #include "serializators/lrxmlserializatorsfactory.h"
 #include "lrcollection.h"
 #include "lrreporttranslation.h"
+#include "serializators/lrserializationschema.h"
 #include <QDebug>
 
 namespace LimeReport{
 
-XMLWriter::XMLWriter() : m_doc(new QDomDocument)
+XMLWriter::XMLWriter() : m_doc(new QDomDocument), m_skipDefaultValues(false)
 {
     init();
 }
 
-XMLWriter::XMLWriter(QSharedPointer<QDomDocument> doc) : m_doc(doc){
+XMLWriter::XMLWriter(QSharedPointer<QDomDocument> doc) : m_doc(doc), m_skipDefaultValues(false){
     init();
 }
 
@@ -119,6 +120,11 @@ void XMLWriter::setPassPhrase(const QString &passPhrase)
     m_passPhrase = passPhrase;
 }
 
+void XMLWriter::setSkipDefaultValues(bool value)
+{
+    m_skipDefaultValues = value;
+}
+
 QDomElement XMLWriter::putQObjectItem(QString name, QObject *item)
 {
     Q_UNUSED(name)
@@ -129,40 +135,35 @@ QDomElement XMLWriter::putQObjectItem(QString name, QObject *item)
     return itemNode;
 }
 
-void XMLWriter::saveProperty(QString name, QObject* item, QDomElement *node)
+void XMLWriter::saveProperty(const SchemaPropertyDesc& desc, const SerializationSchema* schema, QObject* item, QDomElement *node)
 {
-    QString typeName;
-    if (name.compare("itemIndexMethod")==0)
-        typeName = item->metaObject()->property(item->metaObject()->indexOfProperty(name.toLatin1())).typeName();
-    else
-        typeName = item->property(name.toLatin1()).typeName();
-
-    CreateSerializator creator=0;
-    if (isCollection(name, item)) { saveCollection(name,item,node); return; }
-    if (isTranslation(name, item)) { saveTranslation(name, item, node); return; }
-
-    if (isQObject(name,item)) {
-        if (qvariant_cast<QObject *>(item->property(name.toLatin1())))
-            putQObjectProperty(name,qvariant_cast<QObject *>(item->property(name.toLatin1())),node);
+    QString name = QString::fromLatin1(desc.name);
+    switch (desc.kind) {
+    case SchemaPropertyDesc::Collection:
+        saveCollection(name, item, node);
+        return;
+    case SchemaPropertyDesc::Translation:
+        saveTranslation(name, item, node);
+        return;
+    case SchemaPropertyDesc::ChildObject:{
+        QObject* childObject = qvariant_cast<QObject *>(desc.metaProperty.read(item));
+        if (childObject)
+            putQObjectProperty(name, childObject, node);
         else {
             qDebug()<<"Warnig property can`t be casted to QObject"<<name;
         }
         return;
     }
+    default:
+        break;
+    }
 
-    if (enumOrFlag(name,item))
-        creator=XMLAbstractSerializatorFactory::instance().objectCreator(
-                    "enumAndFlags"
-                );
-    else
-    try {
-        creator=XMLAbstractSerializatorFactory::instance().objectCreator(typeName);
-    } catch (LimeReport::ReportError &exception){
-        qDebug()<<"class name ="<<item->metaObject()->className()
-               <<"property name="<<name<<" property type="<<typeName
-               <<exception.what();
+    QVariant value = desc.metaProperty.read(item);
+    if (m_skipDefaultValues && schema->isDefaultValue(desc, value)) return;
 
-    }
+    CreateSerializator creator = SerializationSchemaCache::instance().serializatorCreator(
+        desc.kind == SchemaPropertyDesc::Variant ? QString(value.typeName()) : desc.serializatorType
+    );
 
     if (creator) {
         QScopedPointer<SerializatorIntf> serializator(creator(m_doc.data(),node));
@@ -170,38 +171,18 @@ void XMLWriter::saveProperty(QString name, QObject* item, QDomElement *node)
         if (cs){
             cs->setPassPhrase(m_passPhrase);
         }
-        serializator->save(
-            item->property(name.toLatin1()),
-            name
-        );
+        serializator->save(value, name);
     }
 }
 
 void XMLWriter::saveProperties(QObject *item, QDomElement *node)
 {
-    for (int i=0;i<item->metaObject()->propertyCount();i++){
-        saveProperty(item->metaObject()->property(i).name(),item,node);
+    const SerializationSchema* schema = SerializationSchemaCache::instance().schema(item);
+    foreach (const SchemaPropertyDesc& desc, schema->properties()) {
+        saveProperty(desc, schema, item, node);
     }
 }
 
-bool XMLWriter::enumOrFlag(QString name, QObject *item)
-{
-    return item->metaObject()->property(item->metaObject()->indexOfProperty(name.toLatin1())).isFlagType() ||
-           item->metaObject()->property(item->metaObject()->indexOfProperty(name.toLatin1())).isEnumType();
-}
-
-bool XMLWriter::isCollection(QString propertyName, QObject* item)
-{
-    QMetaProperty prop=item->metaObject()->property(item->metaObject()->indexOfProperty(propertyName.toLatin1()));
-    return QMetaType::type(prop.typeName())==COLLECTION_TYPE_ID;
-}
-
-bool XMLWriter::isTranslation(QString propertyName, QObject* item)
-{
-    QMetaProperty prop=item->metaObject()->property(item->metaObject()->indexOfProperty(propertyName.toLatin1()));
-    return QMetaType::type(prop.typeName())==TRANSLATION_TYPE_ID;
-}
-
 void XMLWriter::saveCollection(QString propertyName, QObject *item, QDomElement *node)
 {
     ICollectionContainer * collection = dynamic_cast<ICollectionContainer*>(item);
@@ -251,12 +232,6 @@ void XMLWriter::saveTranslation(QString propertyName, QObject* item, QDomElement
 
 }
 
-bool XMLWriter::isQObject(QString propertyName, QObject *item)
-{
-    QMetaProperty prop=item->metaObject()->property(item->metaObject()->indexOfProperty(propertyName.toLatin1()));
-    return QMetaType::type(prop.typeName())==QMetaType::QObjectStar;
-}
-
 bool XMLWriter::replaceNode(QDomElement node, QObject* item)
 {
     QDomElement element = m_rootElement.firstChildElement(item->metaObject()->className());
@@ -33,6 +33,7 @@
 #include <QtXml>
 #include "serializators/lrstorageintf.h"
 #include "serializators/lrxmlserializatorsfactory.h"
+#include "serializators/lrserializationschema.h"
 #include "lrbasedesignintf.h"
 
 namespace LimeReport{
@@ -50,6 +51,7 @@ private:
     QString saveToString();
     QByteArray saveToByteArray();
     void setPassPhrase(const QString &passPhrase);
+    void setSkipDefaultValues(bool value);
 
     void init();
     QDomElement putQObjectItem(QString name, QObject* item);
@@ -58,20 +60,17 @@ private:
     void putQObjectProperty(QString propertyName, QObject *item, QDomElement* parentNode=0);
     void saveProperties(QObject* item, QDomElement* node);
     bool setContent(QString fileName);
-    void saveProperty(QString name, QObject* item, QDomElement* node);
-    bool enumOrFlag(QString name, QObject* item);
+    void saveProperty(const SchemaPropertyDesc& desc, const SerializationSchema* schema, QObject* item, QDomElement* node);
     QString extractClassName(QObject* item);
-    bool isCollection(QString propertyName, QObject *item);
-    bool isTranslation(QString propertyName, QObject *item);
     void saveCollection(QString propertyName, QObject *item, QDomElement *node);
     void saveTranslation(QString propertyName, QObject *item, QDomElement *node);
-    bool isQObject(QString propertyName, QObject *item);
     bool replaceNode(QDomElement node, QObject *item);
 private:
     QSharedPointer<QDomDocument> m_doc;
     QString m_fileName;
     QDomElement m_rootElement;
     QString m_passPhrase;
+    bool m_skipDefaultValues;
 };
 
 }
@@ -0,0 +1,183 @@
+#include <QString>
+#include <QtTest>
+#include "../../limereport/lrcolumnardatasource.h"
+
+class ColumnarDataSourceTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ColumnarDataSourceTest();
+private:
+    LimeReport::ColumnarDataTable createTable();
+private Q_SLOTS:
+    void testColumnTypes();
+    void testNulls();
+    void testColumnErrors();
+    void testColumnIndex();
+    void testNavigation();
+    void testDataByKeyField();
+    void testModel();
+    void testSharedColumns();
+};
+
+ColumnarDataSourceTest::ColumnarDataSourceTest()
+{
+}
+
+LimeReport::ColumnarDataTable ColumnarDataSourceTest::createTable()
+{
+    QVector<qint64> ids;
+    ids << 1 << 2 << 3;
+    QVector<QString> names;
+    names << "Mazda" << "Nissan" << "Toyota";
+    QVector<double> prices;
+    prices << 1.5 << 2.25 << 0;
+    QBitArray priceNulls(3);
+    priceNulls.setBit(2);
+
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("id", ids);
+    table.addColumn("name", names);
+    table.addColumn("price", prices, priceNulls);
+    return table;
+}
+
+void ColumnarDataSourceTest::testColumnTypes()
+{
+    QVector<QDate> dates;
+    dates << QDate(2020, 1, 2) << QDate(2021, 3, 4);
+    QVector<QDateTime> times;
+    times << QDateTime(QDate(2020, 1, 2), QTime(10, 0)) << QDateTime(QDate(2021, 3, 4), QTime(11, 30));
+    QVector<QByteArray> blobs;
+    blobs << QByteArray("\x01\x02", 2) << QByteArray();
+
+    LimeReport::ColumnarDataTable table;
+    QVERIFY(table.addColumn("date", dates));
+    QVERIFY(table.addColumn("time", times));
+    QVERIFY(table.addColumn("blob", blobs));
+    QCOMPARE(table.rowCount(), 2);
+    QCOMPARE(table.columnCount(), 3);
+    QCOMPARE(table.columnType(0), LimeReport::ColumnarDataTable::DateColumn);
+    QCOMPARE(table.columnType(1), LimeReport::ColumnarDataTable::DateTimeColumn);
+    QCOMPARE(table.columnType(2), LimeReport::ColumnarDataTable::BlobColumn);
+    QCOMPARE(table.value(1, 0), QVariant(QDate(2021, 3, 4)));
+    QCOMPARE(table.value(0, 1), QVariant(QDateTime(QDate(2020, 1, 2), QTime(10, 0))));
+    QCOMPARE(table.value(0, 2).toByteArray(), QByteArray("\x01\x02", 2));
+
+    LimeReport::ColumnarDataTable numbers = createTable();
+    QCOMPARE(numbers.columnType(0), LimeReport::ColumnarDataTable::Int64Column);
+    QCOMPARE(numbers.columnType(1), LimeReport::ColumnarDataTable::StringColumn);
+    QCOMPARE(numbers.columnType(2), LimeReport::ColumnarDataTable::DoubleColumn);
+    QCOMPARE(numbers.value(1, 0), QVariant(qint64(2)));
+    QCOMPARE(numbers.value(1, 2), QVariant(2.25));
+}
+
+void ColumnarDataSourceTest::testNulls()
+{
+    LimeReport::ColumnarDataTable table = createTable();
+    QVERIFY(!table.isNull(0, 2));
+    QVERIFY(table.isNull(2, 2));
+    QVERIFY(!table.value(2, 2).isValid());
+    QVERIFY(!table.isNull(2, 0));
+    QVERIFY(table.isNull(3, 0));
+    QVERIFY(table.isNull(0, 3));
+    QVERIFY(!table.value(-1, 0).isValid());
+}
+
+void ColumnarDataSourceTest::testColumnErrors()
+{
+    LimeReport::ColumnarDataTable table = createTable();
+    QVector<qint64> shortColumn;
+    shortColumn << 1;
+    QVERIFY(!table.addColumn("short", shortColumn));
+    QVERIFY(!table.lastError().isEmpty());
+
+    QVector<qint64> values;
+    values << 1 << 2 << 3;
+    QVERIFY(!table.addColumn("id", values));
+    QVERIFY(!table.addColumn("", values));
+    QVERIFY(!table.addColumn("nulls", values, QBitArray(2)));
+    QCOMPARE(table.columnCount(), 3);
+    QVERIFY(table.addColumn("qty", values));
+    QCOMPARE(table.columnCount(), 4);
+
+    table.clear();
+    QCOMPARE(table.columnCount(), 0);
+    QCOMPARE(table.rowCount(), 0);
+    QVERIFY(table.addColumn("short", shortColumn));
+    QCOMPARE(table.rowCount(), 1);
+}
+
+void ColumnarDataSourceTest::testColumnIndex()
+{
+    LimeReport::ColumnarDataSource ds(createTable());
+    QCOMPARE(ds.columnCount(), 3);
+    QCOMPARE(ds.columnIndexByName("name"), 1);
+    QCOMPARE(ds.columnIndexByName("PRICE"), 2);
+    QCOMPARE(ds.columnIndexByName("unknown"), -1);
+    QCOMPARE(ds.columnNameByIndex(0), QString("id"));
+    QCOMPARE(ds.columnNameByIndex(5), QString());
+}
+
+void ColumnarDataSourceTest::testNavigation()
+{
+    LimeReport::ColumnarDataSource ds(createTable());
+    QVERIFY(ds.bof());
+    ds.first();
+    QCOMPARE(ds.data("name").toString(), QString("Mazda"));
+    QVERIFY(ds.next());
+    QCOMPARE(ds.data("name").toString(), QString("Nissan"));
+    QVERIFY(ds.hasNext());
+    QVERIFY(ds.next());
+    QVERIFY(!ds.hasNext());
+    QVERIFY(!ds.data("price").isValid());
+    QVERIFY(ds.next());
+    QVERIFY(ds.eof());
+    QVERIFY(!ds.next());
+    QVERIFY(ds.prior());
+    QCOMPARE(ds.data("name").toString(), QString("Nissan"));
+    ds.last();
+    QCOMPARE(ds.data("id").toLongLong(), qlonglong(3));
+    QCOMPARE(ds.dataByRowIndex("name", 0).toString(), QString("Mazda"));
+}
+
+void ColumnarDataSourceTest::testDataByKeyField()
+{
+    LimeReport::ColumnarDataSource ds(createTable());
+    QCOMPARE(ds.dataByKeyField("name", "id", QVariant(qint64(2))).toString(), QString("Nissan"));
+    QCOMPARE(ds.dataByKeyField("id", "name", QVariant("Toyota")).toLongLong(), qlonglong(3));
+    QVERIFY(!ds.dataByKeyField("name", "id", QVariant(qint64(7))).isValid());
+    QVERIFY(!ds.dataByKeyField("unknown", "id", QVariant(qint64(2))).isValid());
+}
+
+void ColumnarDataSourceTest::testModel()
+{
+    LimeReport::ColumnarDataSource ds(createTable());
+    QAbstractItemModel* model = ds.model();
+    QVERIFY(model);
+    QCOMPARE(model, ds.model());
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->columnCount(), 3);
+    QCOMPARE(model->headerData(1, Qt::Horizontal).toString(), QString("name"));
+    QCOMPARE(model->data(model->index(2, 1)).toString(), QString("Toyota"));
+    QVERIFY(!model->data(model->index(2, 2)).isValid());
+    QVERIFY(!model->data(model->index(0, 0), Qt::DecorationRole).isValid());
+}
+
+void ColumnarDataSourceTest::testSharedColumns()
+{
+    QVector<qint64> values(1000, 42);
+    LimeReport::ColumnarDataTable table;
+    QVERIFY(table.addColumn("value", values));
+    // the caller changing its vector detaches it, the table keeps its copy
+    values[0] = 7;
+    QCOMPARE(table.value(0, 0), QVariant(qint64(42)));
+    LimeReport::ColumnarDataSource ds(table);
+    table.clear();
+    QCOMPARE(ds.dataByRowIndex("value", 999), QVariant(qint64(42)));
+}
+
+QTEST_APPLESS_MAIN(ColumnarDataSourceTest)
+
+#include "tst_columnardatasourcetest.moc"
@@ -0,0 +1,151 @@
+#include <QString>
+#include <QtTest>
+#include "../../limereport/lrcsvdatasource.h"
+
+class CSVDataSourceTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    CSVDataSourceTest();
+private Q_SLOTS:
+    void testHeaderAndPlainCells();
+    void testQuotedCells();
+    void testEscapedQuotes();
+    void testEmbeddedNewlines();
+    void testCRLFAndShortRows();
+    void testTypeInference();
+    void testTypeChangeAfterSample();
+    void testNavigation();
+};
+
+CSVDataSourceTest::CSVDataSourceTest()
+{
+}
+
+void CSVDataSourceTest::testHeaderAndPlainCells()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("name;city\nAnn;Oslo\nBob;Rome\n", ";", true, false);
+    QCOMPARE(ds.columnCount(), 2);
+    QCOMPARE(ds.rowCount(), 2);
+    QCOMPARE(ds.columnNameByIndex(1), QString("city"));
+    QCOMPARE(ds.columnIndexByName("CITY"), 1);
+    QCOMPARE(ds.columnIndexByName("country"), -1);
+    QCOMPARE(ds.cellData(1, 0).toString(), QString("Bob"));
+    QCOMPARE(ds.cellData(0, 1).toString(), QString("Oslo"));
+
+    ds.setCSVText("a\tb\n1\t2\n", "\\t", false, false);
+    QCOMPARE(ds.rowCount(), 2);
+    QCOMPARE(ds.columnNameByIndex(0), QString("1"));
+    QCOMPARE(ds.cellData(1, 1).toString(), QString("2"));
+    QCOMPARE(ds.columnIndexByName("city"), -1);
+    QCOMPARE(ds.columnIndexByName("2"), 1);
+
+    ds.setCSVText("Code;code\n1;2\n", ";", true, false);
+    QCOMPARE(ds.columnIndexByName("CODE"), 0);
+}
+
+void CSVDataSourceTest::testQuotedCells()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("name,comment\n\"Smith, John\",\"\"\n\"a\",b\n", ",", true, false);
+    QCOMPARE(ds.rowCount(), 2);
+    QCOMPARE(ds.cellData(0, 0).toString(), QString("Smith, John"));
+    QCOMPARE(ds.cellData(0, 1).toString(), QString(""));
+    QCOMPARE(ds.cellData(1, 0).toString(), QString("a"));
+    QCOMPARE(ds.cellData(1, 1).toString(), QString("b"));
+}
+
+void CSVDataSourceTest::testEscapedQuotes()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("text\n\"he said \"\"hi\"\"\"\n\"\"\"\"\n", ",", true, false);
+    QCOMPARE(ds.rowCount(), 2);
+    QCOMPARE(ds.cellData(0, 0).toString(), QString("he said \"hi\""));
+    QCOMPARE(ds.cellData(1, 0).toString(), QString("\""));
+}
+
+void CSVDataSourceTest::testEmbeddedNewlines()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("id,text\n1,\"first\nsecond\"\n2,\"a\r\nb\"\n", ",", true, true);
+    QCOMPARE(ds.rowCount(), 2);
+    QCOMPARE(ds.cellData(0, 1).toString(), QString("first\nsecond"));
+    QCOMPARE(ds.cellData(1, 1).toString(), QString("a\r\nb"));
+    QCOMPARE(ds.cellData(1, 0).toLongLong(), qlonglong(2));
+}
+
+void CSVDataSourceTest::testCRLFAndShortRows()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("a,b,c\r\n1,2,3\r\n4\r\n5,6,\r\n", ",", true, false);
+    QCOMPARE(ds.rowCount(), 3);
+    QCOMPARE(ds.cellData(0, 2).toString(), QString("3"));
+    QCOMPARE(ds.cellData(1, 0).toString(), QString("4"));
+    QVERIFY(!ds.cellData(1, 1).isValid());
+    QVERIFY(!ds.cellData(1, 2).isValid());
+    QCOMPARE(ds.cellData(2, 2).toString(), QString(""));
+    QVERIFY(!ds.cellData(3, 0).isValid());
+    QVERIFY(!ds.cellData(0, 3).isValid());
+}
+
+void CSVDataSourceTest::testTypeInference()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("int,double,text,zip\n1,1.5,x,0123\n-20,2,y,0456\n,,,\n", ",", true, true);
+    QCOMPARE(ds.columnType(0), LimeReport::CSVDataSource::IntegerColumn);
+    QCOMPARE(ds.columnType(1), LimeReport::CSVDataSource::DoubleColumn);
+    QCOMPARE(ds.columnType(2), LimeReport::CSVDataSource::StringColumn);
+    QCOMPARE(ds.columnType(3), LimeReport::CSVDataSource::StringColumn);
+    QCOMPARE(ds.cellData(1, 0).type(), QVariant::LongLong);
+    QCOMPARE(ds.cellData(1, 0).toLongLong(), qlonglong(-20));
+    QCOMPARE(ds.cellData(0, 1).toDouble(), 1.5);
+    QCOMPARE(ds.cellData(0, 3).toString(), QString("0123"));
+    QVERIFY(!ds.cellData(2, 0).isValid());
+    QVERIFY(!ds.cellData(2, 1).isValid());
+}
+
+void CSVDataSourceTest::testTypeChangeAfterSample()
+{
+    QString csv = "value,amount\n";
+    for (int i = 0; i < 1000; ++i)
+        csv += QString("%1,%1.5\n").arg(i + 1);
+    csv += "n/a,\"1\"\"5\"\n";
+    csv += "12.5,abc\n";
+    csv += "7,8\n";
+
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText(csv, ",", true, true);
+    QCOMPARE(ds.rowCount(), 1003);
+    QCOMPARE(ds.columnType(0), LimeReport::CSVDataSource::IntegerColumn);
+    QCOMPARE(ds.columnType(1), LimeReport::CSVDataSource::DoubleColumn);
+    QCOMPARE(ds.cellData(999, 0).toLongLong(), qlonglong(1000));
+    QCOMPARE(ds.cellData(1000, 0), QVariant(QString("n/a")));
+    QCOMPARE(ds.cellData(1000, 1), QVariant(QString("1\"5")));
+    QCOMPARE(ds.cellData(1001, 0), QVariant(QString("12.5")));
+    QCOMPARE(ds.cellData(1001, 1), QVariant(QString("abc")));
+    QCOMPARE(ds.cellData(1002, 0), QVariant(qlonglong(7)));
+    QCOMPARE(ds.cellData(1002, 1), QVariant(8.0));
+}
+
+void CSVDataSourceTest::testNavigation()
+{
+    LimeReport::CSVDataSource ds;
+    ds.setCSVText("id,name\n1,a\n2,b\n3,c\n", ",", true, true);
+    QVERIFY(ds.bof());
+    ds.first();
+    QCOMPARE(ds.data("name").toString(), QString("a"));
+    QVERIFY(ds.next());
+    QCOMPARE(ds.data("name").toString(), QString("b"));
+    QVERIFY(ds.hasNext());
+    ds.last();
+    QCOMPARE(ds.data("name").toString(), QString("c"));
+    QVERIFY(!ds.hasNext());
+    QCOMPARE(ds.dataByRowIndex("id", 1).toLongLong(), qlonglong(2));
+    QCOMPARE(ds.dataByKeyField("name", "id", QVariant(qlonglong(3))).toString(), QString("c"));
+}
+
+QTEST_APPLESS_MAIN(CSVDataSourceTest)
+
+#include "tst_csvdatasourcetest.moc"
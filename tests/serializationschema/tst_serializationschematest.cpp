@@ -0,0 +1,188 @@
+#include <QString>
+#include <QtTest>
+#include "../../limereport/lrbasedesignintf.h"
+#include "../../limereport/lrdesignelementsfactory.h"
+#include "../../limereport/serializators/lrxmlwriter.h"
+#include "../../limereport/serializators/lrxmlreader.h"
+#include "../../limereport/serializators/lrxmlbasetypesserializators.h"
+#include "../../limereport/serializators/lrxmlserializatorsfactory.h"
+
+class SchemaTestItem : public LimeReport::BaseDesignIntf
+{
+    Q_OBJECT
+    Q_PROPERTY(int weight READ weight WRITE setWeight)
+    Q_PROPERTY(QString caption READ caption WRITE setCaption)
+    Q_PROPERTY(QPoint anchor READ anchor WRITE setAnchor)
+public:
+    SchemaTestItem(const QString& storageTypeName = "SchemaTestItem", QObject* owner = 0, QGraphicsItem* parent = 0)
+        : LimeReport::BaseDesignIntf(storageTypeName, owner, parent), m_weight(5), m_caption("none"){}
+    int weight() const {return m_weight;}
+    void setWeight(int value){m_weight = value;}
+    QString caption() const {return m_caption;}
+    void setCaption(const QString& value){m_caption = value;}
+    QPoint anchor() const {return m_anchor;}
+    void setAnchor(const QPoint& value){m_anchor = value;}
+    virtual BaseDesignIntf* createSameTypeItem(QObject* owner = 0, QGraphicsItem* parent = 0){
+        return new SchemaTestItem(storageTypeName(), owner, parent);
+    }
+private:
+    int m_weight;
+    QString m_caption;
+    QPoint m_anchor;
+};
+
+class LateTestItem : public SchemaTestItem
+{
+    Q_OBJECT
+public:
+    LateTestItem(QObject* owner = 0, QGraphicsItem* parent = 0)
+        : SchemaTestItem("LateTestItem", owner, parent){}
+    virtual BaseDesignIntf* createSameTypeItem(QObject* owner = 0, QGraphicsItem* parent = 0){
+        return new LateTestItem(owner, parent);
+    }
+};
+
+class XmlQPointSerializator : public LimeReport::XmlBaseSerializator
+{
+public:
+    XmlQPointSerializator(QDomDocument *doc, QDomElement *node):XmlBaseSerializator(doc,node){}
+private:
+    virtual void save(const QVariant &value, QString name){
+        QDomElement _node = doc()->createElement(name);
+        _node.setAttribute("Type","QPoint");
+        _node.setAttribute("x",value.toPoint().x());
+        _node.setAttribute("y",value.toPoint().y());
+        node()->appendChild(_node);
+    }
+    virtual QVariant loadValue(){
+        return QPoint(node()->attribute("x").toInt(), node()->attribute("y").toInt());
+    }
+};
+
+namespace{
+
+LimeReport::BaseDesignIntf* createSchemaTestItem(QObject* owner, LimeReport::BaseDesignIntf* parent){
+    return new SchemaTestItem("SchemaTestItem", owner, parent);
+}
+
+LimeReport::BaseDesignIntf* createLateTestItem(QObject* owner, LimeReport::BaseDesignIntf* parent){
+    return new LateTestItem(owner, parent);
+}
+
+LimeReport::SerializatorIntf* createQPointSerializator(QDomDocument *doc, QDomElement *node){
+    return new XmlQPointSerializator(doc, node);
+}
+
+}
+
+class SerializationSchemaTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SerializationSchemaTest();
+private:
+    QString write(QObject* item);
+    void read(const QString& xml, QObject* item);
+private Q_SLOTS:
+    void initTestCase();
+    void testDefaultValuesSkipped();
+    void testChangedValuesRoundTrip();
+    void testItemRegisteredAfterFirstUse();
+    void testSerializatorRegisteredAfterFirstUse();
+};
+
+SerializationSchemaTest::SerializationSchemaTest()
+{
+}
+
+QString SerializationSchemaTest::write(QObject *item)
+{
+    QScopedPointer<LimeReport::ItemsWriterIntf> writer(new LimeReport::XMLWriter());
+    writer->setSkipDefaultValues(true);
+    writer->putItem(item);
+    return writer->saveToString();
+}
+
+void SerializationSchemaTest::read(const QString &xml, QObject *item)
+{
+    LimeReport::ItemsReaderIntf::Ptr reader = LimeReport::StringXMLreader::create(xml);
+    QVERIFY(reader->first());
+    QVERIFY(reader->readItem(item));
+}
+
+void SerializationSchemaTest::initTestCase()
+{
+    LimeReport::DesignElementsFactory::instance().registerCreator(
+        "SchemaTestItem", LimeReport::ItemAttribs("Schema Test Item", "Item"), createSchemaTestItem
+    );
+}
+
+void SerializationSchemaTest::testDefaultValuesSkipped()
+{
+    SchemaTestItem item;
+    QString xml = write(&item);
+    QVERIFY(!xml.contains("<weight"));
+    QVERIFY(!xml.contains("<caption"));
+
+    SchemaTestItem loaded;
+    loaded.setWeight(1);
+    read(xml, &loaded);
+    QCOMPARE(loaded.weight(), 1);
+}
+
+void SerializationSchemaTest::testChangedValuesRoundTrip()
+{
+    SchemaTestItem item;
+    item.setWeight(7);
+    item.setCaption("changed");
+    QString xml = write(&item);
+    QVERIFY(xml.contains("<weight"));
+    QVERIFY(xml.contains("<caption"));
+
+    SchemaTestItem loaded;
+    read(xml, &loaded);
+    QCOMPARE(loaded.weight(), 7);
+    QCOMPARE(loaded.caption(), QString("changed"));
+}
+
+void SerializationSchemaTest::testItemRegisteredAfterFirstUse()
+{
+    LateTestItem item;
+    // no prototype to take defaults from yet, every value is written
+    QVERIFY(write(&item).contains("<weight"));
+
+    LimeReport::DesignElementsFactory::instance().registerCreator(
+        "LateTestItem", LimeReport::ItemAttribs("Late Test Item", "Item"), createLateTestItem
+    );
+    QVERIFY(!write(&item).contains("<weight"));
+
+    item.setWeight(7);
+    QString xml = write(&item);
+    QVERIFY(xml.contains("<weight"));
+    QVERIFY(!xml.contains("<caption"));
+
+    LateTestItem loaded;
+    read(xml, &loaded);
+    QCOMPARE(loaded.weight(), 7);
+    QCOMPARE(loaded.caption(), QString("none"));
+}
+
+void SerializationSchemaTest::testSerializatorRegisteredAfterFirstUse()
+{
+    SchemaTestItem item;
+    item.setAnchor(QPoint(3, 4));
+    QVERIFY(!write(&item).contains("<anchor"));
+
+    LimeReport::XMLAbstractSerializatorFactory::instance().registerCreator("QPoint", createQPointSerializator);
+    QString xml = write(&item);
+    QVERIFY(xml.contains("<anchor"));
+
+    SchemaTestItem loaded;
+    read(xml, &loaded);
+    QCOMPARE(loaded.anchor(), QPoint(3, 4));
+}
+
+QTEST_MAIN(SerializationSchemaTest)
+
+#include "tst_serializationschematest.moc"
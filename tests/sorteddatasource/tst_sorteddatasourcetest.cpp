@@ -0,0 +1,205 @@
+#include <QString>
+#include <QtTest>
+#include "../../limereport/lrglobal.h"
+#include "../../limereport/lrcolumnardatasource.h"
+#include "../../limereport/lrsorteddatasource.h"
+
+class SortedDataSourceTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SortedDataSourceTest();
+private:
+    LimeReport::ColumnarDataTable createTable();
+    QStringList values(LimeReport::IDataSource* dataSource, const QString& columnName);
+private Q_SLOTS:
+    void testStability();
+    void testParallelStability();
+    void testNulls();
+    void testMultiKeyDesc();
+    void testTextKeys();
+    void testTypeHints();
+    void testErrors();
+    void testSetSource();
+};
+
+SortedDataSourceTest::SortedDataSourceTest()
+{
+}
+
+LimeReport::ColumnarDataTable SortedDataSourceTest::createTable()
+{
+    QVector<qint64> ids;
+    ids << 1 << 2 << 3 << 4 << 5 << 6;
+    QVector<QString> groups;
+    groups << "b" << "a" << "b" << "a" << "b" << "a";
+    QVector<double> prices;
+    prices << 2 << 0 << 1 << 3 << 2 << 1;
+    QBitArray priceNulls(6);
+    priceNulls.setBit(1);
+
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("id", ids);
+    table.addColumn("group", groups);
+    table.addColumn("price", prices, priceNulls);
+    return table;
+}
+
+QStringList SortedDataSourceTest::values(LimeReport::IDataSource *dataSource, const QString &columnName)
+{
+    QStringList result;
+    dataSource->first();
+    while (!dataSource->eof()){
+        result << dataSource->data(columnName).toString();
+        dataSource->next();
+    }
+    return result;
+}
+
+void SortedDataSourceTest::testStability()
+{
+    LimeReport::ColumnarDataSource source(createTable());
+    LimeReport::SortedDataSource sorted(&source, "group");
+    QCOMPARE(values(&sorted, "id"), QStringList() << "2" << "4" << "6" << "1" << "3" << "5");
+
+    LimeReport::SortedDataSource sortedDesc(&source, "group desc");
+    QCOMPARE(values(&sortedDesc, "id"), QStringList() << "1" << "3" << "5" << "2" << "4" << "6");
+}
+
+void SortedDataSourceTest::testParallelStability()
+{
+    int count = LimeReport::Const::SORT_PARALLEL_THRESHOLD + 1000;
+    QVector<qint64> ids;
+    QVector<qint64> keys;
+    for (int i = 0; i < count; ++i){
+        ids << i;
+        keys << (count - i) % 7;
+    }
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("id", ids);
+    table.addColumn("key", keys);
+    LimeReport::ColumnarDataSource source(table);
+    LimeReport::SortedDataSource sorted(&source, "key");
+
+    int rows = 0;
+    qint64 previousKey = -1;
+    qint64 previousId = -1;
+    sorted.first();
+    while (!sorted.eof()){
+        qint64 key = sorted.data("key").toLongLong();
+        qint64 id = sorted.data("id").toLongLong();
+        QVERIFY(key >= previousKey);
+        if (key == previousKey) QVERIFY(id > previousId);
+        previousKey = key;
+        previousId = id;
+        ++rows;
+        sorted.next();
+    }
+    QCOMPARE(rows, count);
+}
+
+void SortedDataSourceTest::testNulls()
+{
+    LimeReport::ColumnarDataSource source(createTable());
+    LimeReport::SortedDataSource sorted(&source, "price");
+    QCOMPARE(values(&sorted, "id"), QStringList() << "2" << "3" << "6" << "1" << "5" << "4");
+    QVERIFY(sorted.dataByRowIndex("price", 0).isNull());
+
+    LimeReport::SortedDataSource sortedDesc(&source, "price desc");
+    QCOMPARE(values(&sortedDesc, "id"), QStringList() << "4" << "1" << "5" << "3" << "6" << "2");
+    QVERIFY(sortedDesc.dataByRowIndex("price", 5).isNull());
+}
+
+void SortedDataSourceTest::testMultiKeyDesc()
+{
+    LimeReport::ColumnarDataSource source(createTable());
+    LimeReport::SortedDataSource sorted(&source, "group desc, price desc");
+    QCOMPARE(values(&sorted, "id"), QStringList() << "1" << "5" << "3" << "4" << "6" << "2");
+
+    LimeReport::SortedDataSource mixed(&source, " group  ASC ,price desc , id desc");
+    QCOMPARE(values(&mixed, "id"), QStringList() << "4" << "6" << "2" << "5" << "1" << "3");
+}
+
+void SortedDataSourceTest::testTextKeys()
+{
+    QVector<QString> numbers;
+    numbers << "10" << " 9" << "100" << "-1.5";
+    QVector<QString> dates;
+    dates << "2021-03-04" << "2020-01-02T10:00:00" << "2020-01-02" << "1999-12-31";
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("number", numbers);
+    table.addColumn("date", dates);
+    LimeReport::ColumnarDataSource source(table);
+
+    LimeReport::SortedDataSource byNumber(&source, "number");
+    QCOMPARE(values(&byNumber, "number"), QStringList() << "-1.5" << " 9" << "10" << "100");
+
+    LimeReport::SortedDataSource byDate(&source, "date desc");
+    QCOMPARE(values(&byDate, "date"),
+             QStringList() << "2021-03-04" << "2020-01-02T10:00:00" << "2020-01-02" << "1999-12-31");
+}
+
+void SortedDataSourceTest::testTypeHints()
+{
+    QVector<QString> codes;
+    codes << "10" << "9" << "x" << "100";
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("code", codes);
+    LimeReport::ColumnarDataSource source(table);
+
+    LimeReport::SortedDataSource detected(&source, "code");
+    QCOMPARE(values(&detected, "code"), QStringList() << "10" << "100" << "9" << "x");
+
+    LimeReport::SortedDataSource asString(&source, "code:string");
+    QCOMPARE(values(&asString, "code"), QStringList() << "10" << "100" << "9" << "x");
+
+    // values a hinted key cannot convert are ordered as nulls
+    LimeReport::SortedDataSource asNumber(&source, "code:number");
+    QCOMPARE(values(&asNumber, "code"), QStringList() << "x" << "9" << "10" << "100");
+
+    LimeReport::SortedDataSource asNumberDesc(&source, "code:Number desc");
+    QCOMPARE(values(&asNumberDesc, "code"), QStringList() << "100" << "10" << "9" << "x");
+    QVERIFY(asNumberDesc.lastError().isEmpty());
+}
+
+void SortedDataSourceTest::testErrors()
+{
+    LimeReport::ColumnarDataSource source(createTable());
+    LimeReport::SortedDataSource unknownField(&source, "missing, id desc");
+    QVERIFY(!unknownField.lastError().isEmpty());
+    QCOMPARE(values(&unknownField, "id"), QStringList() << "6" << "5" << "4" << "3" << "2" << "1");
+
+    LimeReport::SortedDataSource unknownType(&source, "id:money");
+    QVERIFY(!unknownType.lastError().isEmpty());
+    QCOMPARE(values(&unknownType, "id"), QStringList() << "1" << "2" << "3" << "4" << "5" << "6");
+}
+
+void SortedDataSourceTest::testSetSource()
+{
+    LimeReport::ColumnarDataSource source(createTable());
+    LimeReport::SortedDataSource sorted(&source, "id desc");
+    sorted.next();
+    QCOMPARE(sorted.data("id").toInt(), 5);
+
+    QVector<qint64> ids;
+    ids << 7 << 9 << 8;
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("id", ids);
+    LimeReport::ColumnarDataSource reopened(table);
+    sorted.setSource(&reopened);
+    QVERIFY(sorted.source() == &reopened);
+    QCOMPARE(sorted.data("id").toInt(), 9);
+    QCOMPARE(values(&sorted, "id"), QStringList() << "9" << "8" << "7");
+
+    sorted.setSource(0);
+    QVERIFY(sorted.eof());
+    QVERIFY(sorted.bof());
+    QVERIFY(sorted.isInvalid());
+    QVERIFY(!sorted.data("id").isValid());
+    QCOMPARE(sorted.columnCount(), 0);
+}
+
+QTEST_APPLESS_MAIN(SortedDataSourceTest)
+
+#include "tst_sorteddatasourcetest.moc"
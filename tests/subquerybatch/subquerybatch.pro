@@ -0,0 +1,21 @@
+QT       += testlib gui widgets sql
+
+TARGET = tst_subquerybatchtest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../common.pri)
+include(../../limereport/limereport.pri)
+
+INCLUDEPATH += $$ZINT_PATH/backend $$ZINT_PATH/backend_qt4
+DEPENDPATH += $$ZINT_PATH/backend $$ZINT_PATH/backend_qt4
+LIBS += -L$${DEST_LIBS} -lQtZint
+
+SOURCES += \
+        tst_subquerybatchtest.cpp
+
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
@@ -0,0 +1,218 @@
+#include <QString>
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include "../../limereport/lrreportengine.h"
+#include "../../limereport/lrdatasourcemanager.h"
+#include "../../limereport/lrdatadesignintf.h"
+#include "../../limereport/lrcolumnardatatable.h"
+
+const QString CONNECTION_NAME = "subquerybatch";
+
+class SubQueryBatchTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SubQueryBatchTest();
+private:
+    void fillOrders(const QString& ids);
+    void addDetails(const QString& sql, const QString& batchKeyField, int batchSize);
+    QStringList detailItems();
+    QString detailError();
+    void exec(const QString& sql);
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testWindowsAcrossFetches();
+    void testNullAndDuplicateKeys();
+    void testLeadingNullKey();
+    void testMissingBatchKeyField();
+    void testMasterWithoutPosition();
+    void testTwoMasterFields();
+    void testEmptyMasterFallback();
+private:
+    LimeReport::ReportEngine* m_report;
+    LimeReport::DataSourceManager* m_dataManager;
+    LimeReport::IDataSource* m_orders;
+};
+
+SubQueryBatchTest::SubQueryBatchTest()
+    : m_report(0), m_dataManager(0), m_orders(0)
+{
+}
+
+void SubQueryBatchTest::exec(const QString &sql)
+{
+    QSqlQuery query(QSqlDatabase::database(CONNECTION_NAME));
+    QVERIFY2(query.exec(sql), qPrintable(sql));
+}
+
+// ids: comma separated master keys in row order, "null" for a NULL key
+void SubQueryBatchTest::fillOrders(const QString &ids)
+{
+    int pos = 0;
+    foreach (QString id, ids.split(',', QString::SkipEmptyParts)) {
+        exec(QString("insert into orders values (%1, %2)").arg(pos++).arg(id));
+    }
+    m_dataManager->addQuery("orders", "select id from orders order by pos", CONNECTION_NAME);
+}
+
+void SubQueryBatchTest::addDetails(const QString &sql, const QString &batchKeyField, int batchSize)
+{
+    m_dataManager->addSubQuery("lines", sql, CONNECTION_NAME, "orders");
+    m_dataManager->setSubQueryBatchMode("lines", batchKeyField, batchSize);
+    m_orders = m_dataManager->dataSource("orders");
+    QVERIFY(m_orders);
+}
+
+QStringList SubQueryBatchTest::detailItems()
+{
+    m_dataManager->updateChildrenData("orders");
+    LimeReport::IDataSource* lines = m_dataManager->dataSource("lines");
+    if (!lines) return QStringList() << "#error";
+    QStringList result;
+    lines->first();
+    while (!lines->eof()){
+        result << lines->data("item").toString();
+        lines->next();
+    }
+    return result;
+}
+
+QString SubQueryBatchTest::detailError()
+{
+    m_dataManager->updateChildrenData("orders");
+    return m_dataManager->dataSourceHolder("lines")->lastError();
+}
+
+void SubQueryBatchTest::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+    db.setDatabaseName(":memory:");
+    QVERIFY(db.open());
+}
+
+void SubQueryBatchTest::init()
+{
+    exec("create table orders (pos integer, id integer)");
+    exec("create table lines (order_id integer, item varchar(10))");
+    exec("insert into lines values (1, 'a1')");
+    exec("insert into lines values (2, 'b1')");
+    exec("insert into lines values (2, 'b2')");
+    exec("insert into lines values (3, 'c1')");
+    exec("insert into lines values (4, 'd1')");
+    exec("insert into lines values (5, 'e1')");
+    m_report = new LimeReport::ReportEngine();
+    m_dataManager = dynamic_cast<LimeReport::DataSourceManager*>(m_report->dataManager());
+    QVERIFY(m_dataManager);
+}
+
+void SubQueryBatchTest::cleanup()
+{
+    delete m_report;
+    m_report = 0;
+    m_dataManager = 0;
+    m_orders = 0;
+    exec("drop table orders");
+    exec("drop table lines");
+}
+
+void SubQueryBatchTest::testWindowsAcrossFetches()
+{
+    fillOrders("1,2,3,4,5");
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id}) order by item", "order_id", 2);
+
+    m_orders->first();
+    QCOMPARE(detailItems(), QStringList() << "a1");
+
+    // rows of the current window are already fetched, the next window is not
+    exec("delete from lines where order_id in (2, 3)");
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList() << "b1" << "b2");
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList());
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList() << "d1");
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList() << "e1");
+}
+
+void SubQueryBatchTest::testNullAndDuplicateKeys()
+{
+    fillOrders("1,null,1,2");
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id}) order by item",
+               "order_id", LimeReport::SubQueryHolder::ALL_MASTER_ROWS);
+
+    m_orders->first();
+    QCOMPARE(detailItems(), QStringList() << "a1");
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList());
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList() << "a1");
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList() << "b1" << "b2");
+    QVERIFY(m_dataManager->dataSourceHolder("lines")->lastError().isEmpty());
+}
+
+void SubQueryBatchTest::testLeadingNullKey()
+{
+    fillOrders("null,null");
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id})", "order_id", 10);
+
+    m_orders->first();
+    QCOMPARE(detailItems(), QStringList());
+    QCOMPARE(m_dataManager->dataSource("lines")->columnCount(), 2);
+    m_orders->next();
+    QCOMPARE(detailItems(), QStringList());
+}
+
+void SubQueryBatchTest::testMissingBatchKeyField()
+{
+    fillOrders("1,2");
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id})", "no_such_field", 2);
+
+    m_orders->first();
+    QVERIFY(detailError().contains("no_such_field"));
+    QVERIFY(!m_dataManager->dataSource("lines"));
+}
+
+void SubQueryBatchTest::testMasterWithoutPosition()
+{
+    QVector<qint64> ids;
+    ids << 1 << 2;
+    LimeReport::ColumnarDataTable table;
+    table.addColumn("id", ids);
+    QVERIFY(m_dataManager->addColumnarData("orders", table));
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id})", "order_id", 2);
+
+    m_orders->first();
+    QVERIFY(detailError().contains("master datasource must be a query or a model"));
+}
+
+void SubQueryBatchTest::testTwoMasterFields()
+{
+    fillOrders("1,2");
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id}) and item <> $D{orders.pos}",
+               "order_id", 2);
+
+    m_orders->first();
+    QVERIFY(detailError().contains("only one master field can be batched"));
+}
+
+void SubQueryBatchTest::testEmptyMasterFallback()
+{
+    fillOrders("");
+    addDetails("select order_id, item from lines where order_id in ($D{orders.id})", "order_id", 2);
+
+    // nothing to batch, the subquery runs once with the NULL master value
+    m_orders->first();
+    QVERIFY(m_orders->eof());
+    QCOMPARE(detailItems(), QStringList());
+    QVERIFY(m_dataManager->dataSourceHolder("lines")->lastError().isEmpty());
+}
+
+QTEST_MAIN(SubQueryBatchTest)
+
+#include "tst_subquerybatchtest.moc"
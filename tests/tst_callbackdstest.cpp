@@ -11,14 +11,25 @@ public:
 private:
     LimeReport::CallbackDatasource* m_testDS;
     LimeReport::CallbackDatasource* m_test1DS;
+    LimeReport::CallbackDatasource* m_blockDS;
+    LimeReport::CallbackDatasource* m_emptyBlockDS;
     int m_currentRow;
+    int m_blockRequests;
+    int m_cellRequests;
 protected Q_SLOTS:
     void slotTestOneSlotDS(LimeReport::CallbackInfo info, QVariant& data);
     void slotGetCallbackData(LimeReport::CallbackInfo info, QVariant& data);
     void slotChangePos(const LimeReport::CallbackInfo::ChangePosType& type, bool& result);
+    void slotGetBlockHeaders(LimeReport::CallbackInfo info, QVariant& data);
+    void slotGetDataBlock(LimeReport::CallbackInfo info, QVector<QVariantList>& rows);
+    void slotGetEmptyDataBlock(LimeReport::CallbackInfo info, QVector<QVariantList>& rows);
 private Q_SLOTS:
     void testOneSlotDS();
     void testTwoSlotDS();
+    void testBlockDS();
+    void testBlockDSByRowIndex();
+    void testBlockDSByKeyField();
+    void testEmptyBlockDS();
 
 };
 
@@ -34,6 +45,22 @@ CallbackDSTest::CallbackDSTest()
             this, SLOT(slotGetCallbackData(LimeReport::CallbackInfo,QVariant&)));
     connect(m_test1DS, SIGNAL(changePos(LimeReport::CallbackInfo::ChangePosType,bool&)),
             this, SLOT(slotChangePos(LimeReport::CallbackInfo::ChangePosType,bool&)));
+
+    m_blockRequests = 0;
+    m_cellRequests = 0;
+    m_blockDS = new LimeReport::CallbackDatasource();
+    m_blockDS->setBlockSize(4);
+    connect(m_blockDS, SIGNAL(getCallbackData(LimeReport::CallbackInfo,QVariant&)),
+            this, SLOT(slotGetBlockHeaders(LimeReport::CallbackInfo,QVariant&)));
+    connect(m_blockDS, SIGNAL(getCallbackDataBlock(LimeReport::CallbackInfo,QVector<QVariantList>&)),
+            this, SLOT(slotGetDataBlock(LimeReport::CallbackInfo,QVector<QVariantList>&)));
+
+    m_emptyBlockDS = new LimeReport::CallbackDatasource();
+    m_emptyBlockDS->setBlockSize(4);
+    connect(m_emptyBlockDS, SIGNAL(getCallbackData(LimeReport::CallbackInfo,QVariant&)),
+            this, SLOT(slotGetBlockHeaders(LimeReport::CallbackInfo,QVariant&)));
+    connect(m_emptyBlockDS, SIGNAL(getCallbackDataBlock(LimeReport::CallbackInfo,QVector<QVariantList>&)),
+            this, SLOT(slotGetEmptyDataBlock(LimeReport::CallbackInfo,QVector<QVariantList>&)));
 }
 
 
@@ -255,6 +282,119 @@ void CallbackDSTest::testTwoSlotDS()
     QCOMPARE(m_test1DS->data("Value").toInt(),9);
 }
 
+void CallbackDSTest::slotGetBlockHeaders(LimeReport::CallbackInfo info, QVariant& data)
+{
+    QStringList columns;
+    columns << "Name" << "Value";
+    switch (info.dataType) {
+        case LimeReport::CallbackInfo::ColumnCount:
+            data = columns.size();
+            break;
+        case LimeReport::CallbackInfo::ColumnHeaderData:
+            data = columns.at(info.index);
+            break;
+        case LimeReport::CallbackInfo::ColumnData:
+            m_cellRequests++;
+            break;
+        default: break;
+    }
+}
+
+void CallbackDSTest::slotGetDataBlock(LimeReport::CallbackInfo info, QVector<QVariantList>& rows)
+{
+    m_blockRequests++;
+    QCOMPARE(info.dataType, LimeReport::CallbackInfo::RowBlock);
+    QCOMPARE(info.columnNames, QStringList() << "Name" << "Value");
+    for (int row = info.index; row < info.index + info.blockSize && row < 10; ++row){
+        QVariantList values;
+        values << QString("Name%1").arg(row) << row;
+        rows.append(values);
+    }
+}
+
+void CallbackDSTest::slotGetEmptyDataBlock(LimeReport::CallbackInfo info, QVector<QVariantList>& rows)
+{
+    Q_UNUSED(info)
+    Q_UNUSED(rows)
+    m_blockRequests++;
+}
+
+void CallbackDSTest::testBlockDS()
+{
+    m_blockRequests = 0;
+    m_cellRequests = 0;
+    QCOMPARE(m_blockDS->blockSize(), 4);
+    QVERIFY2(m_blockDS->bof(), "Failure test bof");
+    QVERIFY2(!m_blockDS->eof(), "Failure test eof");
+    QVERIFY2(!m_blockDS->data("Name").isValid(),"Failure test data on bof");
+    QVERIFY2(m_blockDS->hasNext(), "Failure hasNext");
+    QCOMPARE(m_blockRequests, 1);
+    QVERIFY2(m_blockDS->next(), "Failure next");
+    QCOMPARE(m_blockDS->data("Name").toString(),QString("Name0"));
+    QCOMPARE(m_blockDS->data("Value").toInt(),0);
+    for (int i = 1; i < 4; ++i) QVERIFY2(m_blockDS->next(), "Failure next");
+    QCOMPARE(m_blockDS->data("Value").toInt(),3);
+    QCOMPARE(m_blockRequests, 1);
+    QVERIFY2(m_blockDS->next(), "Failure next");
+    QCOMPARE(m_blockDS->data("Name").toString(),QString("Name4"));
+    QCOMPARE(m_blockRequests, 2);
+    QVERIFY2(m_blockDS->prior(), "Failure test prior");
+    QCOMPARE(m_blockDS->data("Value").toInt(),3);
+    int rows = 4;
+    while (m_blockDS->next()) ++rows;
+    QCOMPARE(rows, 10);
+    QCOMPARE(m_blockDS->eof(), true);
+    QCOMPARE(m_blockDS->hasNext(), false);
+    QCOMPARE(m_blockDS->next(), false);
+    QCOMPARE(m_blockDS->data("Value").toInt(),9);
+    QCOMPARE(m_cellRequests, 0);
+
+    m_blockDS->first();
+    QCOMPARE(m_blockDS->eof(), false);
+    QCOMPARE(m_blockDS->data("Name").toString(),QString("Name0"));
+}
+
+void CallbackDSTest::testBlockDSByRowIndex()
+{
+    m_cellRequests = 0;
+    m_blockDS->first();
+    QCOMPARE(m_blockDS->dataByRowIndex("Name", 1).toString(),QString("Name1"));
+    m_blockRequests = 0;
+    QCOMPARE(m_blockDS->dataByRowIndex("Value", 3).toInt(),3);
+    QCOMPARE(m_blockRequests, 0);
+    QCOMPARE(m_blockDS->dataByRowIndex("Value", 9).toInt(),9);
+    QCOMPARE(m_blockRequests, 1);
+    QVERIFY(!m_blockDS->dataByRowIndex("Value", 12).isValid());
+    QVERIFY(!m_blockDS->dataByRowIndex("Value", -1).isValid());
+    // the cursor is not moved by random access
+    QCOMPARE(m_blockDS->data("Name").toString(),QString("Name0"));
+    QCOMPARE(m_cellRequests, 0);
+}
+
+void CallbackDSTest::testBlockDSByKeyField()
+{
+    m_cellRequests = 0;
+    m_blockDS->first();
+    QCOMPARE(m_blockDS->dataByKeyField("Name", "Value", 8).toString(),QString("Name8"));
+    QCOMPARE(m_blockDS->dataByKeyField("Name", "Value", 9).toString(),QString("Name9"));
+    QCOMPARE(m_blockDS->dataByKeyField("Name", "Value", 2).toString(),QString("Name2"));
+    QCOMPARE(m_blockDS->dataByKeyField("Value", "Name", QString("Name5")).toInt(),5);
+    QVERIFY(!m_blockDS->dataByKeyField("Name", "Value", 42).isValid());
+    QCOMPARE(m_blockDS->data("Name").toString(),QString("Name0"));
+    QCOMPARE(m_cellRequests, 0);
+}
+
+void CallbackDSTest::testEmptyBlockDS()
+{
+    m_blockRequests = 0;
+    m_emptyBlockDS->first();
+    QCOMPARE(m_emptyBlockDS->eof(), true);
+    QCOMPARE(m_emptyBlockDS->hasNext(), false);
+    QCOMPARE(m_emptyBlockDS->next(), false);
+    QVERIFY(!m_emptyBlockDS->dataByRowIndex("Name", 0).isValid());
+    QCOMPARE(m_blockRequests, 1);
+}
+
 QTEST_APPLESS_MAIN(CallbackDSTest)
 
 #include "tst_callbackdstest.moc"